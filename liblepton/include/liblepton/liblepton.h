@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <libguile.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 
 G_BEGIN_DECLS
 
@@ -40,6 +40,15 @@ typedef struct _LeptonListClass LeptonListClass;
 struct _LeptonList {
   GObject parent;
   GList *glist;
+
+  /* Membership index: maps items to the first node holding them */
+  GHashTable *nodes;
+  GList *tail;
+  guint duplicates;
+
+  /* Nesting level of lepton_list_begin_update() */
+  guint update_level;
+  gboolean changed;
 };
 
 struct _LeptonListClass {
@@ -58,6 +67,15 @@ void lepton_list_remove( LeptonList *list, gpointer item );
 void lepton_list_remove_all( LeptonList *list );
 void lepton_list_move_item( LeptonList* list, gpointer item, gint newpos );
 
+gboolean
+lepton_list_contains (LeptonList *list,
+                      gpointer item);
+void
+lepton_list_begin_update (LeptonList *list);
+
+void
+lepton_list_end_update (LeptonList *list);
+
 GList*
 lepton_list_get_glist (LeptonList* list);
 
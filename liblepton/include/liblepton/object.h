@@ -41,8 +41,13 @@ struct st_object
   LeptonPicture *picture;
   LeptonPath *path;
 
-  /* List of connections to and from this object. */
-  GList *conn_list;
+  /* Array of connections (LeptonConn) to and from this object. */
+  GArray *conn_array;
+
+  /* Parent object in the page's union-find structure of nets. */
+  LeptonObject *net_parent;
+  /* Next member of the net in a ring, NULL if the net is unknown. */
+  LeptonObject *net_next;
 
   /* Visible appearance of lines in graphical primitives. */
   LeptonStroke *stroke;
@@ -28,6 +28,7 @@ struct st_page
   int pid;
 
   GList *_object_list;
+  struct st_page_index *_index; /* spatial index of objects */
   LeptonSelection *selection_list; /* selection mechanism */
   GList *place_list;
   LeptonObject *object_lastplace; /* the last found item */
@@ -147,6 +148,12 @@ lepton_page_objects_in_regions (LeptonPage *page,
                                 LeptonBox *rects,
                                 int n_rects,
                                 gboolean include_hidden);
+GList*
+lepton_page_objects_at_point (LeptonPage *page,
+                              int x,
+                              int y,
+                              int slack,
+                              LeptonObject *after);
 const gchar*
 lepton_page_get_filename (const LeptonPage *page);
 
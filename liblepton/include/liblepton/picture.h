@@ -22,6 +22,9 @@
 
 G_BEGIN_DECLS
 
+/* Number of cached surfaces in the picture mipmap chain. */
+#define PICTURE_MIPMAP_LEVELS 4
+
 typedef struct st_picture LeptonPicture;
 
 struct st_picture
@@ -30,6 +33,15 @@ struct st_picture
   gchar *file_content;
   gsize file_length;
 
+  /* Image data is decoded only when the pixbuf is requested for
+   * the first time.  This flag is set once it has been done. */
+  gboolean decoded;
+
+  /* Base64 representation of file_content as last written to a
+   * file, kept to avoid re-encoding of embedded pictures on each
+   * save. */
+  gchar *file_content_base64;
+
   double ratio;
   char *filename;
   int angle;
@@ -39,6 +51,11 @@ struct st_picture
   /* upper is considered the origin */
   int upper_x, upper_y; /* world */
   int lower_x, lower_y;
+
+  /* Cache of premultiplied surfaces used for rendering. Level 0
+   * is the full-resolution image, each next level is half the
+   * size of the previous one. Surfaces are created on demand. */
+  cairo_surface_t *surface[PICTURE_MIPMAP_LEVELS];
 };
 
 LeptonPicture*
@@ -50,4 +67,10 @@ lepton_picture_free (LeptonPicture *picture);
 GdkPixbuf*
 lepton_picture_get_fallback_pixbuf () G_GNUC_WARN_UNUSED_RESULT;
 
+cairo_surface_t*
+lepton_picture_get_surface (LeptonPicture *picture,
+                            double scale) G_GNUC_WARN_UNUSED_RESULT;
+void
+lepton_picture_invalidate_surfaces (LeptonPicture *picture);
+
 G_END_DECLS
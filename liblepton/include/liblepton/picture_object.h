@@ -47,7 +47,7 @@ double
 lepton_picture_object_get_real_ratio (LeptonObject *object);
 
 double
-lepton_picture_object_get_ratio (const LeptonObject *object);
+lepton_picture_object_get_ratio (LeptonObject *object);
 
 void
 lepton_picture_object_set_ratio (LeptonObject *object,
@@ -102,7 +102,7 @@ lepton_picture_object_read (const char *first_line,
                             unsigned int fileformat_ver,
                             GError **err);
 gchar*
-lepton_picture_object_to_buffer (const LeptonObject *object);
+lepton_picture_object_to_buffer (LeptonObject *object);
 
 double
 lepton_picture_object_shortest_distance (LeptonObject *object,
@@ -190,8 +190,22 @@ void s_conn_remove_object_connections (LeptonObject *to_remove);
 void
 s_conn_update_object (LeptonPage* page,
                       LeptonObject *object);
-int s_conn_net_search(LeptonObject* new_net, int whichone, GList * conn_list);
+int s_conn_net_search (LeptonObject* new_net, int whichone);
 GList *s_conn_return_others(GList *input_list, LeptonObject *object);
+void
+s_conn_iter_init (LeptonConnIter *iter,
+                  LeptonObject *object);
+gboolean
+s_conn_iter_next (LeptonConnIter *iter,
+                  LeptonConn *conn);
+guint
+s_conn_count (const LeptonObject *object);
+LeptonObject*
+s_conn_get_other_object (const LeptonObject *object,
+                         guint index);
+void s_conn_print (LeptonObject *object);
+int
+s_conn_get_net_id (LeptonObject *object);
 
 /* s_log.c */
 void s_log_init (const gchar *filename);
@@ -29,6 +29,7 @@ typedef struct _LeptonList LeptonPageList;
 
 /* lepton-schematic structures */
 typedef struct st_conn LeptonConn;
+typedef struct st_conn_iter LeptonConnIter;
 
 /* Managed text buffers */
 typedef struct _TextBuffer TextBuffer;
@@ -69,6 +70,24 @@ struct st_conn {
   int whichone;
   /*! \brief which endpoint of the "other" object caused this connection */
   int other_whichone;
+  /*! \brief index of the reverse connection in the connection array
+    of the "other" object */
+  guint other_index;
+};
+
+/*! \brief Iterator over the connections of a LeptonObject
+ *
+ * The st_conn_iter structure is initialized with s_conn_iter_init()
+ * and advanced with s_conn_iter_next().  Iterating does not
+ * allocate any memory.
+ */
+struct st_conn_iter {
+  /*! \brief The primitive object whose connections are iterated */
+  LeptonObject *current;
+  /*! \brief Remaining primitives if a component is iterated */
+  GList *primitives;
+  /*! \brief Index of the next connection of \a current */
+  guint index;
 };
 
 /*! \brief Type of callback function for object damage notification */
@@ -6,6 +6,7 @@
 #include <glib-object.h>
 #include <libguile.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 #include <glib/gstdio.h>
 
 /* Public headers */
@@ -19,21 +19,13 @@ LeptonObject *o_attrib_find_attrib_by_name (const GList *list, const char *name,
 void o_selection_select (LeptonObject *object);
 void o_selection_unselect (LeptonObject *object);
 
-/* s_conn.c */
-LeptonConn*
-s_conn_return_new (LeptonObject *other_object,
-                   int type,
-                   int x,
-                   int y,
-                   int whichone,
-                   int other_whichone);
-int
-s_conn_uniq (GList *conn_list,
-             LeptonConn *input_conn);
+/* page.c */
+void
+lepton_page_index_object_changed (LeptonPage *page,
+                                  LeptonObject *object);
 
-int s_conn_remove_other (LeptonObject *other_object, LeptonObject *to_remove);
+/* s_conn.c */
 LeptonObject *s_conn_check_midpoint(LeptonObject *o_current, int x, int y);
-void s_conn_print(GList *conn_list);
 void
 s_conn_add_object (LeptonPage *page,
                    LeptonObject *object);
@@ -41,6 +33,7 @@ s_conn_add_object (LeptonPage *page,
 /* s_encoding.c */
 gchar* s_encoding_base64_encode (gchar* src, guint srclen, guint* dstlenp, gboolean strict);
 gchar* s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp);
+gboolean s_encoding_set_vectorized (gboolean enable);
 
 /* s_weakref.c */
 GList *s_weakref_notify (void *dead_ptr, GList *weak_refs);
@@ -108,6 +108,8 @@
             lepton_export_settings_set_format
             lepton_export_settings_set_outfile
 
+            lepton_list_begin_update
+            lepton_list_end_update
             lepton_list_get_glist
 
             lepton_object_get_attached_to
@@ -315,6 +317,7 @@
             s_clib_add_command
             s_clib_add_directory
             s_clib_add_scm
+            s_clib_flush_symbol_cache
             s_clib_get_symbol_by_name
             s_clib_init
             s_clib_symbol_get_filename
@@ -322,6 +325,9 @@
 
             o_attrib_attach
 
+            s_conn_count
+            s_conn_get_net_id
+            s_conn_get_other_object
             s_conn_remove_object
             s_conn_remove_object_connections
             s_conn_return_others
@@ -382,6 +388,7 @@
 (define-lff s_clib_add_command '* '(* * *))
 (define-lff s_clib_add_directory '* '(* *))
 (define-lff s_clib_add_scm '* '(* * *))
+(define-lff s_clib_flush_symbol_cache void '())
 (define-lff s_clib_get_symbol_by_name '* '(*))
 (define-lff s_clib_init void '())
 (define-lff s_clib_symbol_get_filename '* '(*))
@@ -465,6 +472,8 @@
 (define-lff lepton_init_toplevel_fluid void '(*))
 
 ;;; list.c
+(define-lff lepton_list_begin_update void '(*))
+(define-lff lepton_list_end_update void '(*))
 (define-lff lepton_list_get_glist '* '(*))
 
 ;;; object.c
@@ -664,6 +673,9 @@
 (define-lff o_attrib_attach void (list '* '* int))
 
 ;; s_conn.c
+(define-lff s_conn_count unsigned-int '(*))
+(define-lff s_conn_get_net_id int '(*))
+(define-lff s_conn_get_other_object '* (list '* unsigned-int))
 (define-lff s_conn_remove_object void '(* *))
 (define-lff s_conn_remove_object_connections void '(*))
 (define-lff s_conn_return_others '* '(* *))
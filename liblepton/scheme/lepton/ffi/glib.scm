@@ -23,6 +23,7 @@
   #:use-module (lepton ffi lff)
 
   #:export (g_clear_error
+            g_compute_checksum_for_data
             g_free
             g_list_append
             g_list_free
@@ -49,6 +50,8 @@
 
 (define-lff g_clear_error void '(*))
 
+(define-lff g_compute_checksum_for_data '* (list int '* size_t))
+
 (define-lff g_free void '(*))
 
 (define-lff g_list_append '* '(* *))
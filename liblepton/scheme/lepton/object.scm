@@ -45,6 +45,7 @@
             set-object-color!
             object-component
             object-connections
+            object-net-id
             object-embedded?
             set-object-embedded!
             object-id
@@ -213,11 +214,40 @@ as pins, nets, or buses."
                (list object)
                '()))
 
-  (let* ((gls (s_conn_return_others %null-pointer pointer))
-         (ls (glist->list gls pointer->object)))
+  (define (primitive-connections pointer)
+    (let loop ((index (1- (s_conn_count pointer)))
+               (ls '()))
+      (if (< index 0)
+          ls
+          (loop (1- index)
+                (cons (pointer->object (s_conn_get_other_object pointer index))
+                      ls)))))
+
+  (if (true? (lepton_object_is_component pointer))
+      (append-map primitive-connections
+                  (glist->list (lepton_component_object_get_contents pointer)
+                               identity))
+      (primitive-connections pointer)))
+
+
+(define (object-net-id object)
+  "Returns the ID of the net OBJECT belongs to.  All pins, nets,
+and buses connected to each other, directly or through other
+objects, have the same net ID.  The ID does not change until the
+net is split or merged with another one.  Returns #f if OBJECT is
+not a pin, net, or bus.  If OBJECT is not included in a page,
+raises an 'object-state error."
+  (define pointer (check-object object 1))
+
+  (when (null-pointer? (lepton_object_get_page pointer))
+    (scm-error 'object-state
+               'object-net-id
+               "Object ~A is not included in a page."
+               (list object)
+               '()))
 
-    (g_list_free gls)
-    ls))
+  (let ((id (s_conn_get_net_id pointer)))
+    (and (not (zero? id)) id)))
 
 
 (define (object-component object)
@@ -42,12 +42,14 @@
   #:use-module (lepton rc)
   #:use-module (lepton repl)
   #:use-module (lepton version)
+  #:use-module (netlist cache)
   #:use-module (netlist config)
   #:use-module (netlist deprecated)
   #:use-module (netlist error)
   #:use-module (netlist mode)
   #:use-module (netlist schematic)
   #:use-module (netlist package-pin)
+  #:use-module (netlist profile)
   #:use-module (netlist schematic toplevel)
   #:use-module (netlist verbose)
 
@@ -178,17 +180,10 @@ symbol instances within gnetlist (the first element is the value
 associated with the first symbol instance)."
   (define sname (string->symbol attribute-name))
 
-  (define (found-package? package)
-    (let ((name (schematic-component-refdes package)))
-      (and name
-           (string=? name package-name)
-           package)))
-
   (map
    (lambda (package)
      (schematic-component-attribute package sname))
-   (filter-map found-package?
-               (schematic-components (toplevel-schematic)))))
+   (schematic-refdes-components (toplevel-schematic) package-name)))
 
 
 (define (gnetlist:get-package-attribute refdes name)
@@ -334,12 +329,6 @@ REFDES. As a result, slots may be repeated in the returned list."
 (define (get-connections netname schematic)
   "Returns all connections in the form of ((refdes pin) ...) for
 NETNAME in SCHEMATIC."
-  (define (found? x)
-    (and x
-         (string=? x netname)))
-
-  (define netlist (schematic-components schematic))
-
   (define (pin->refdes-pinnumber-pair pin)
     (let* ((component (package-pin-parent pin))
            (refdes (hierarchical-refdes->string
@@ -350,22 +339,28 @@ NETNAME in SCHEMATIC."
            pinnumber
            (cons refdes pinnumber))))
 
-  (define (get-found-pin-connections pin)
-    (if (found? (package-pin-name pin))
-        (filter-map pin->refdes-pinnumber-pair
-                    (if (package-pin-connection pin)
-                        (schematic-connection-pins (package-pin-connection pin))
-                        '()))
-        '()))
+  ;; Pins of a net usually share the same connection, so every
+  ;; connection is processed only once.
+  (define (unique-connections pins)
+    (let ((seen (make-hash-table)))
+      (filter-map
+       (lambda (pin)
+         (let ((connection (package-pin-connection pin)))
+           (and connection
+                (not (hashq-ref seen connection))
+                (hashq-set! seen connection #t)
+                connection)))
+       pins)))
 
-  (define (get-netlist-connections netlist)
-    (append-map
-     (lambda (package)
-       (append-map get-found-pin-connections (schematic-component-pins package)))
-     netlist))
+  (define (get-connection-pairs connection)
+    (filter-map pin->refdes-pinnumber-pair
+                (schematic-connection-pins connection)))
 
-  (sort-remove-duplicates (get-netlist-connections netlist)
-                          pair<?))
+  (sort-remove-duplicates
+   (append-map get-connection-pairs
+               (unique-connections
+                (schematic-netname-pins schematic netname)))
+   pair<?))
 
 (define (get-all-connections netname)
   "Returns all connections in the form of ((refdes pin) ...) for
@@ -377,9 +372,6 @@ NETNAME."
   "For specified REFDES, returns a list of strings defining
 connection pairs in the form (\"pin-number\" . \"net-name\")."
 
-  (define (found? x)
-    (string= x refdes))
-
   (define (get-pin-netname-pair pin)
     (let ((pin-number (package-pin-number pin))
           (pin-name (package-pin-name pin)))
@@ -388,14 +380,14 @@ connection pairs in the form (\"pin-number\" . \"net-name\")."
            (cons pin-number pin-name))))
 
   (define (get-pin-netname-list component)
-     (if (and=> (schematic-component-refdes component) found?)
-         (filter-map get-pin-netname-pair (schematic-component-pins component))
-         '()))
+    (filter-map get-pin-netname-pair (schematic-component-pins component)))
 
   ;; Currently, netlist can contain many `packages' with the same
   ;; name, so we have to deal with this.
   (let ((result-list (append-map get-pin-netname-list
-                                 (schematic-components (toplevel-schematic)))))
+                                 (schematic-refdes-components
+                                  (toplevel-schematic)
+                                  refdes))))
     (sort-remove-duplicates result-list pair<?)))
 
 
@@ -423,33 +415,19 @@ connection pairs in the form (\"pin-number\" . \"net-name\")."
            (member (cons package pin-number) connections)
            connections)))
 
-  (define (found-pin-number? x)
-    (and x
-         (string=? x pin-number)))
-
   (define (lookup-through-pins pins)
-    (filter-map
+    (map
      (lambda (pin)
-       (and (found-pin-number? (package-pin-number pin))
-            (cons (package-pin-name pin)
-                  (lookup-through-connections pin
-                                              package
-                                              pin-number))))
+       (cons (package-pin-name pin)
+             (lookup-through-connections pin
+                                         package
+                                         pin-number)))
      pins))
 
-  (define (found-package? x)
-    (and x
-         (string=? x package)))
-
-  (define (lookup-through-netlist netlist)
-    (append-map
-     (lambda (package)
-       (if (found-package? (schematic-component-refdes package))
-           (lookup-through-pins (schematic-component-pins package))
-           '()))
-     netlist))
-
-  (let ((found (lookup-through-netlist (schematic-components (toplevel-schematic)))))
+  (let ((found (lookup-through-pins
+                (schematic-refdes-pinnumber-pins (toplevel-schematic)
+                                                 package
+                                                 pin-number))))
     (match found
       (((netname . rest) ..1)
        (cons (car netname) (apply append (delq #f rest))))
@@ -680,34 +658,26 @@ other limitations imposed by this netlist format.
                                               pin-attrib-value
                                               name
                                               func)
-  (define (found-refdes? x)
-    (and x
-         (string=? x refdes)))
-
-  (define (find-pin-by-attrib pins name value)
-    (and (not (null? pins))
-         (let* ((pin (car pins))
-                (attrib (assq-ref (package-pin-attribs pin)
-                                  name)))
-           (if (and attrib
-                    (string=? attrib value))
-               pin
-               (find-pin-by-attrib (cdr pins) name value)))))
-
-  (let loop ((netlist (schematic-components (toplevel-schematic))))
-    (if (null? netlist)
+  ;; The candidate pins are precomputed along with the schematic,
+  ;; one per component having the refdes REFDES.  Artificial pins
+  ;; lacking the attribute are only reported by the 'pinnumber
+  ;; index and are handed to FUNC.
+  (define attrib-name (string->symbol pin-attrib-name))
+  (define wanted-name (string->symbol name))
+
+  (let loop ((pins (schematic-refdes-pin-attrib-pins (toplevel-schematic)
+                                                     refdes
+                                                     attrib-name
+                                                     pin-attrib-value)))
+    (if (null? pins)
         "unknown"
-        (or (and (found-refdes? (schematic-component-refdes (car netlist)))
-                 (let ((pin (find-pin-by-attrib (schematic-component-pins (car netlist))
-                                                (string->symbol pin-attrib-name)
-                                                pin-attrib-value)))
-                   (if pin
-                       (assq-ref (package-pin-attribs pin)
-                                 (string->symbol name))
-                       (and func (func (schematic-component-pins (car netlist))
-                                       name
-                                       pin-attrib-value)))))
-            (loop (cdr netlist))))))
+        (or (let ((attribs (package-pin-attribs (car pins))))
+              (if (equal? (assq-ref attribs attrib-name) pin-attrib-value)
+                  (assq-ref attribs wanted-name)
+                  (and func (func (list (car pins))
+                                  name
+                                  pin-attrib-value))))
+            (loop (cdr pins))))))
 
 
 ;;; Supplies pintype 'pwr' for artificial pins having pinnumber.
@@ -822,12 +792,24 @@ General options:
   -q                  Quiet mode.
   -v, --verbose       Verbose mode.
   -o FILE             Filename for netlist data output.
+  --profile           Output time and memory spent in each phase of
+                      netlisting to stderr.
+  --profile-format=FORMAT
+                      Output the profile in FORMAT, either \"text\"
+                      (default) or \"json\".  Implies --profile.
+  --server=SOCKET     Run as a server processing netlist requests
+                      received on the UNIX socket SOCKET.
+  --cache-dir=DIR     Reuse whole netlists cached in DIR if none of
+                      their input files has changed.
   -L DIR              Add DIR to Scheme search path.
-  -g BACKEND          Specify netlist backend to use.
+  -g BACKEND[:FILE]   Specify netlist backend to use.  If FILE is
+                      given, the backend output goes to it instead
+                      of the file specified by -o.  May be given
+                      several times to run several backends.
   -f FILE             Specify path to netlist backend file to use.
   -O STRING           Pass an option string to backend.
-  -l FILE             Load Scheme file before loading backend.
-  -m FILE             Load Scheme file after loading backend.
+  -l FILE             Load Scheme file before loading each backend.
+  -m FILE             Load Scheme file after loading each backend.
   -c EXPR             Evaluate Scheme expression at startup.
   -i                  Enter interactive Scheme REPL after loading.
   -b, --list-backends Print a list of available netlist backends.
@@ -845,12 +827,10 @@ Lepton EDA homepage: <https://github.com/lepton-eda/lepton-eda>
 ;;; Set lepton-netlist toplevel schematic based on schematic FILES
 ;;; and NETLIST-MODE which must be either "'geda", or "'spice".
 (define (set-ln-toplevel-schematic! files)
-  (define (process-gafrc* name)
-    (process-gafrc "lepton-netlist" name))
-
-  (and (eq? (netlist-mode) 'spice)
-       (set! get-uref get-spice-refdes))
-  (for-each process-gafrc* files)
+  (set! get-uref
+        (if (eq? (netlist-mode) 'spice)
+            get-spice-refdes
+            gnetlist:get-uref))
   (catch 'system-error
     (lambda () (set-toplevel-schematic! (make-toplevel-schematic files)))
     (lambda (key subr message args rest)
@@ -896,9 +876,11 @@ Lepton EDA homepage: <https://github.com/lepton-eda/lepton-eda>
   ( opt-list-backends (netlist-option-ref 'list-backends) ) ; --list-backends
   ( opt-pre-load      (netlist-option-ref 'pre-load) )      ; -l
   ( opt-post-load     (netlist-option-ref 'post-load) )     ; -m
-  ( backend-path      #f )
+  ( opt-cache-dir     (netlist-option-ref 'cache-dir) )     ; --cache-dir
+  ( cache-key         #f )
+  ( jobs              '() )
   ( schematic         #f )
-  ( backend-proc-name #f )
+  ( schematic-mode    #f )
   )
 
   ; local functions:
@@ -953,7 +935,7 @@ Lepton EDA homepage: <https://github.com/lepton-eda/lepton-eda>
   ( let*
     (
     ( proc-name 'request-netlist-mode )
-    ( proc      (module-variable (current-module) proc-name) )
+    ( proc      (module-local-variable (current-module) proc-name) )
     ( mode      #f )
     )
 
@@ -969,10 +951,148 @@ Lepton EDA homepage: <https://github.com/lepton-eda/lepton-eda>
   )
   )
 
+  ; Every backend job is a list of the backend name, the path to
+  ; its file, and the output file name, which is #f for stdout.
+  ;
+  ( define job-name car )
+  ( define job-path cadr )
+  ( define job-output caddr )
+
+  ; Backend argument of -g is either "BACKEND" or
+  ; "BACKEND:FILE".  In the former case, output goes to the file
+  ; specified by -o:
+  ;
+  ( define ( backend-arg->job arg )
+  ( let*
+    (
+    ( pos  (string-index arg #\:) )
+    ( name (if pos (string-take arg pos) arg) )
+    ( file (if pos (string-drop arg (1+ pos)) (netlist-option-ref 'output)) )
+    )
+
+    ( list name
+           (%search-load-path (format #f "gnet-~A.scm" name))
+           (and (not (string=? file "-")) file) )
+  )
+  )
+
+  ( define ( check-job-outputs jobs )
+  ( let loop ( ( outputs (filter-map job-output jobs) ) )
+    ( unless ( null? outputs )
+      ( when ( member (car outputs) (cdr outputs) )
+        ( netlist-error 1 (G_ "Several backends would write to the same file ~S.\n~
+                              Use \"-g BACKEND:FILE\" to specify a separate file for each backend.\n")
+                          (car outputs))
+      )
+      ( loop (cdr outputs) )
+    )
+  )
+  )
+
+  ; Load Scheme FILE before loading backend (-l FILE):
+  ;
+  ( define ( load-pre-load )
+    ( catch #t
+      ( lambda()
+        ( for-each primitive-load opt-pre-load )
+      )
+      ( lambda( tag . args )
+        ( catch-handler tag args )
+        ( netlist-error 1 (G_ "Failed to load Scheme file before loading backend.\n") )
+      )
+    )
+  )
+
+  ; Load Scheme FILE after loading backend (-m FILE):
+  ;
+  ( define ( load-post-load )
+    ( catch #t
+      ( lambda()
+        ( for-each primitive-load opt-post-load )
+      )
+      ( lambda( tag . args )
+        ( catch-handler tag args )
+        ( netlist-error 1 (G_ "Failed to load Scheme file after loading backend.\n") )
+      )
+    )
+  )
+
+  ; Every backend is loaded into a fresh module, so definitions
+  ; made by one backend, or by the files loaded along with it,
+  ; are not seen by the backends run after it.  The module
+  ; inherits the bindings of the main module:
+  ;
+  ( define main-module (current-module) )
+
+  ( define ( make-backend-module )
+    ( let ( ( module (make-fresh-user-module) ) )
+      ( module-use! module main-module )
+      module
+    )
+  )
+
+  ; Load backend file of JOB into a fresh module, preceded by the
+  ; files given by -l and followed by the files given by -m, so
+  ; these files are loaded once for every backend.  Netlist mode
+  ; is reset so that a backend not requesting any mode gets the
+  ; default one:
+  ;
+  ( define ( load-backend job )
+    ( unless ( job-path job )
+      ( error-backend-not-found (job-name job) )
+    )
+    ( set-current-module (make-backend-module) )
+    ( set-netlist-mode! (default-netlist-mode) )
+    ( load-pre-load )
+    ( catch #t
+      ( lambda()
+        ( primitive-load (job-path job) )
+        ( query-backend-mode )
+      )
+      ( lambda( tag . args )
+        ( catch-handler tag args )
+        ( netlist-error 1 (G_ "Failed to load backend file.\n") )
+      )
+    )
+    ( load-post-load )
+  )
+
+  ; Build toplevel schematic unless it has been already built in
+  ; the current netlist mode:
+  ;
+  ( define ( build-schematic )
+    ( unless ( eq? schematic-mode (netlist-mode) )
+      ; Process gafrc files in schematic directories only once.
+      ( unless schematic-mode
+        ( with-profile-phase "gafrc files"
+          ( for-each (cut process-gafrc "lepton-netlist" <>) files )
+        )
+      )
+      ; This sets [toplevel-schematic] global variable:
+      ;
+      ( set! schematic
+        ( with-profile-phase "schematic"
+          ( set-ln-toplevel-schematic! files )
+        )
+      )
+      ( set! schematic-mode (netlist-mode) )
+
+      ; Verbose mode (-v): print internal netlist representation:
+      ;
+      ( when opt-verbose
+        ( verbose-print-netlist (schematic-components schematic) )
+      )
+    )
+  )
+
 
   ; Parse configuration:
   ;
-  (parse-rc "lepton-netlist" "gnetlistrc")
+  ; This includes setting up of symbol libraries.
+  ;
+  ( with-profile-phase "rc files"
+    ( parse-rc "lepton-netlist" "gnetlistrc" )
+  )
 
   ; Set default netlist mode:
   ;
@@ -1013,92 +1133,89 @@ Lepton EDA homepage: <https://github.com/lepton-eda/lepton-eda>
   )
 
 
-  ; Load Scheme FILE before loading backend (-l FILE):
+  ; Backends specified by name (-g) and by file name (-f):
   ;
-  ( catch #t
-    ( lambda()
-      ( for-each primitive-load opt-pre-load )
-    )
-    ( lambda( tag . args )
-      ( catch-handler tag args )
-      ( netlist-error 1 (G_ "Failed to load Scheme file before loading backend.\n") )
+  ( set! jobs
+    ( append
+      ( map backend-arg->job opt-backend )
+      ( if opt-file-backend
+        ( list (list (get-backend-proc-name opt-file-backend)
+                     opt-file-backend
+                     output-filename) ) ; if
+        '()                             ; else
+      )
     )
   )
 
-  ; Backend specified by name:
-  ;
-  ( when opt-backend
-    ( set! backend-path ( %search-load-path (format #f "gnet-~A.scm" opt-backend) ) )
-    ( set! backend-proc-name opt-backend )
-  )
+  ( check-job-outputs jobs )
 
-  ; Backend specified by file name:
+  ; Neither backend (-g or -f), nor interactive mode (-i) specified:
   ;
-  ( when opt-file-backend
-    ( set! backend-path opt-file-backend )
-    ( set! backend-proc-name (get-backend-proc-name backend-path) )
+  ( unless ( or (not (null? jobs)) opt-interactive )
+    ( error-no-backend )
   )
 
-
-  ; Load backend file:
+  ; Cache directory (--cache-dir): reuse the netlist if none of
+  ; its input files has changed since it was cached:
   ;
-  ( when backend-path
-    ( catch #t
-      ( lambda()
-        ( primitive-load backend-path )
-        ( query-backend-mode )
-      )
-      ( lambda( tag . args )
-        ( catch-handler tag args )
-        ( netlist-error 1 (G_ "Failed to load backend file.\n") )
-      )
+  ( when ( and opt-cache-dir
+               (= (length jobs) 1)
+               (job-output (car jobs))
+               (job-path (car jobs))
+               (not opt-interactive) )
+    ( set! cache-key (make-netlist-cache-key (job-path (car jobs))) )
+    ( when ( netlist-cache-restore opt-cache-dir
+                                   cache-key
+                                   (job-output (car jobs)) )
+      ( profile-report )
+      ( primitive-exit 0 )
     )
   )
 
-  ; Load Scheme FILE after loading backend (-m FILE):
-  ;
-  ( catch #t
-    ( lambda()
-      ( for-each primitive-load opt-post-load )
+  ( if opt-interactive
+    ( begin
+      ( if ( null? jobs )
+        ( begin                         ; if
+          ( load-pre-load )
+          ( load-post-load )
+        )
+        ( for-each load-backend jobs )  ; else
+      )
+      ( when opt-verbose
+        ( print-netlist-config )
+      )
+      ( build-schematic )
+      ( lepton-repl )
     )
-    ( lambda( tag . args )
-      ( catch-handler tag args )
-      ( netlist-error 1 (G_ "Failed to load Scheme file after loading backend.\n") )
+    ; Do actual work: run each backend in turn, rebuilding the
+    ; schematic only if the backend requests another netlist mode.
+    ( for-each
+      ( lambda ( job )
+        ( load-backend job )
+        ( when ( and opt-verbose (eq? job (car jobs)) )
+          ( print-netlist-config )
+        )
+        ( build-schematic )
+        ( with-profile-phase (format #f "backend ~A" (job-name job))
+          ( run-backend (job-name job) (job-output job) )
+        )
+      )
+      jobs
     )
   )
 
-  ; Verbose mode (-v): print configuration:
-  ;
-  ( when opt-verbose
-    ( print-netlist-config )
-  )
-
-  ; Neither backend (-g or -f), nor interactive mode (-i) specified:
-  ;
-  ( unless ( or opt-backend opt-file-backend opt-interactive )
-    ( error-no-backend )
+  ( when cache-key
+    ( netlist-cache-store! opt-cache-dir
+                           cache-key
+                           (job-output (car jobs))
+                           ( apply netlist-cache-dependencies
+                                   (job-path (car jobs))
+                                   (append opt-pre-load opt-post-load) ) )
   )
 
-  ; This sets [toplevel-schematic] global variable:
-  ;
-  (set! schematic (set-ln-toplevel-schematic! files))
-
-  ; Verbose mode (-v): print internal netlist representation:
+  ; Profiling (--profile): output the time spent in each phase:
   ;
-  ( when opt-verbose
-    ( verbose-print-netlist (schematic-components schematic) )
-  )
-
-
-  ; Do actual work:
-  ;
-  ( if opt-interactive
-    ( lepton-repl )                             ; if
-    ( if ( and backend-path backend-proc-name ) ; else
-      ( run-backend backend-proc-name output-filename ) ; if
-      ( error-backend-not-found opt-backend )           ; else
-    )
-  )
+  ( profile-report )
 
 ) ; let
 ) ; main()
@@ -0,0 +1,302 @@
+;;; Lepton EDA netlister
+;;; Copyright (C) 2022 Lepton EDA Contributors
+;;;
+;;; This program is free software; you can redistribute it and/or modify
+;;; it under the terms of the GNU General Public License as published by
+;;; the Free Software Foundation; either version 2 of the License, or
+;;; (at your option) any later version.
+;;;
+;;; This program is distributed in the hope that it will be useful,
+;;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;;; GNU General Public License for more details.
+;;;
+;;; You should have received a copy of the GNU General Public License
+;;; along with this program; if not, write to the Free Software
+;;; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+;;; Netlist cache.
+;;;
+;;; The cache stores netlists produced by lepton-netlist in a
+;;; directory specified by the "--cache-dir" option.  Every entry
+;;; is keyed by a hash of the program version, the working
+;;; directory, the command line, and the environment variables
+;;; affecting Scheme module lookup and configuration, and consists
+;;; of two files: KEY.out containing the netlist, and KEY.deps
+;;; containing the list of files the netlist depends on, that is,
+;;; all schematic pages, including hierarchical sub-sheets, all
+;;; symbol files, the backend file, the source files of all Scheme
+;;; modules loaded, rc and configuration files, and component and
+;;; source library directories, along with the hashes of their
+;;; contents.  For directories, the hash of the list of their
+;;; entries is used, so adding a symbol that shadows another one
+;;; is noticed.  Missing rc and configuration files are recorded
+;;; as well, so creating one invalidates the entry.  If none of the
+;;; dependencies has changed, the netlist is just copied from the
+;;; cache.  Both files are written to temporary files first and
+;;; then renamed, so the cache directory can be safely deleted at
+;;; any time.
+;;;
+;;; The cache works on whole netlists: if anything has changed,
+;;; even a single page of a large hierarchy, the netlist is
+;;; generated from scratch.  Nothing is reused per page.
+
+(define-module (netlist cache)
+  #:use-module (ice-9 binary-ports)
+  #:use-module (ice-9 ftw)
+  #:use-module (srfi srfi-1)
+  #:use-module (system foreign)
+
+  #:use-module (lepton ffi glib)
+  #:use-module (lepton gettext)
+  #:use-module (lepton library)
+  #:use-module (lepton library component)
+  #:use-module (lepton log)
+  #:use-module (lepton object)
+  #:use-module (lepton os)
+  #:use-module (lepton page)
+  #:use-module (lepton version)
+
+  #:export (make-netlist-cache-key
+            netlist-cache-dependencies
+            netlist-cache-restore
+            netlist-cache-store!))
+
+;;; GChecksumType value for SHA-256.
+(define G_CHECKSUM_SHA256 2)
+
+(define (bytevector->checksum bv)
+  "Returns SHA-256 checksum of bytevector BV as a hexadecimal
+string."
+  (let* ((pointer (g_compute_checksum_for_data G_CHECKSUM_SHA256
+                                               (bytevector->pointer bv)
+                                               (bytevector-length bv)))
+         (checksum (pointer->string pointer)))
+    (g_free pointer)
+    checksum))
+
+
+(define (file-checksum filename)
+  "Returns checksum of the contents of FILENAME, or #f if the
+file cannot be read."
+  (catch 'system-error
+    (lambda ()
+      (let ((bv (call-with-input-file filename get-bytevector-all
+                  #:binary #t)))
+        (bytevector->checksum (if (eof-object? bv) #vu8() bv))))
+    (lambda (key . args) #f)))
+
+
+(define (directory-checksum dirname)
+  "Returns checksum of the sorted list of entries of DIRNAME, or
+#f if the directory cannot be read."
+  (let ((entries (scandir dirname)))
+    (and entries
+         (bytevector->checksum
+          (string->utf8 (string-join entries "\n"))))))
+
+
+(define (dependency-checksum filename)
+  "Returns checksum of FILENAME, which may be a regular file or a
+directory, or #f if it does not exist or cannot be read."
+  (and (file-exists? filename)
+       (if (file-is-directory? filename)
+           (directory-checksum filename)
+           (file-checksum filename))))
+
+
+(define %key-environment-variables
+  '("GUILE_LOAD_PATH"
+    "GUILE_LOAD_COMPILED_PATH"
+    "HOME"
+    "LANG"
+    "LANGUAGE"
+    "LC_ALL"
+    "LC_MESSAGES"
+    "LEPTON_INHIBIT_RC_FILES"
+    "XDG_CONFIG_DIRS"
+    "XDG_CONFIG_HOME"
+    "XDG_DATA_DIRS"
+    "XDG_DATA_HOME"))
+
+
+(define (make-netlist-cache-key . args)
+  "Returns a cache key for the current netlister run.  The key
+depends on the program version, the working directory, the
+command line arguments, the values of environment variables
+affecting module lookup and configuration, the Scheme load path,
+and optional ARGS, which must be printable objects."
+  (bytevector->checksum
+   (string->utf8
+    (format #f "~S"
+            (list (lepton-version-data 'dotted 'date 'git)
+                  (getcwd)
+                  (program-arguments)
+                  (map getenv %key-environment-variables)
+                  %load-path
+                  args)))))
+
+
+(define (loaded-module-files)
+  "Returns the absolute file names of the source files of all
+loaded Scheme modules, including those used by the backend."
+  (define (module-files module files)
+    (hash-fold (lambda (name submodule files)
+                 (module-files submodule files))
+               (let ((filename (module-filename module)))
+                 (if filename (cons filename files) files))
+               (module-submodules module)))
+
+  (filter-map (lambda (filename)
+                (if (absolute-file-name? filename)
+                    filename
+                    (%search-load-path filename)))
+              (module-files (resolve-module '() #f) '())))
+
+
+(define (rc-file-candidates pages)
+  "Returns the list of rc and configuration files that may affect
+netlisting of PAGES, whether they exist or not."
+  (define (in-dirs dirs . basenames)
+    (append-map (lambda (dir)
+                  (map (lambda (basename)
+                         (string-append dir file-name-separator-string basename))
+                       basenames))
+                dirs))
+
+  ;; Local configuration is looked up in parent directories, too.
+  (define (ancestors dir)
+    (let ((parent (dirname dir)))
+      (if (string=? parent dir)
+          (list dir)
+          (cons dir (ancestors parent)))))
+
+  (let ((local-dirs (delete-duplicates
+                     (cons (getcwd)
+                           (map (lambda (page)
+                                  (dirname (canonicalize-path (page-filename page))))
+                                (filter (lambda (page)
+                                          (file-exists? (page-filename page)))
+                                        pages))))))
+    (append
+     (in-dirs (sys-config-dirs)
+              "system-gafrc" "system-gnetlistrc" "lepton-system.conf")
+     (in-dirs (list (user-config-dir))
+              "gafrc" "gnetlistrc" "lepton-user.conf")
+     (in-dirs local-dirs "gafrc" "gnetlistrc")
+     (in-dirs (delete-duplicates (append-map ancestors local-dirs))
+              "lepton.conf"))))
+
+
+(define (netlist-cache-dependencies . files)
+  "Returns the list of absolute file names the current netlist
+depends on: the file names of all active pages, the symbol files
+of the components on them, FILES, the source files of loaded
+Scheme modules, the component and source library directories, and
+the rc and configuration files that may affect the result,
+including missing ones."
+  (define (component-filenames page)
+    (filter-map component-filename
+                (filter component? (page-contents page))))
+
+  (let ((pages (active-pages)))
+    (delete-duplicates
+     (append
+      (map canonicalize-path
+           (filter file-exists?
+                   (append (map page-filename pages)
+                           (append-map component-filenames pages)
+                           files
+                           (loaded-module-files)
+                           (map symbol-library-path (component-libraries))
+                           (source-library-contents
+                            %default-source-library))))
+      (rc-file-candidates pages)))))
+
+
+(define (cache-filename cache-dir key suffix)
+  (string-append cache-dir file-name-separator-string key suffix))
+
+
+(define (read-dependencies filename)
+  (catch #t
+    (lambda ()
+      (let ((deps (call-with-input-file filename read)))
+        (and (list? deps)
+             (every (lambda (dep)
+                      (and (pair? dep)
+                           (string? (car dep))
+                           (or (string? (cdr dep))
+                               (not (cdr dep)))))
+                    deps)
+             deps)))
+    (lambda (key . args) #f)))
+
+
+(define (copy-file* source destination)
+  "Copies SOURCE to DESTINATION through a temporary file in the
+directory of DESTINATION, which is then renamed."
+  (let* ((port (mkstemp! (string-append destination ".XXXXXX")))
+         (tmp (port-filename port)))
+    (close-port port)
+    (copy-file source tmp)
+    (rename-file tmp destination)))
+
+
+(define (netlist-cache-restore cache-dir key output-filename)
+  "Copies the cached netlist for KEY from CACHE-DIR to
+OUTPUT-FILENAME if it is up to date.  Returns #t on success and
+#f otherwise."
+  (define deps-filename (cache-filename cache-dir key ".deps"))
+  (define out-filename (cache-filename cache-dir key ".out"))
+
+  (define (up-to-date? dep)
+    (equal? (dependency-checksum (car dep)) (cdr dep)))
+
+  (and (file-exists? deps-filename)
+       (file-exists? out-filename)
+       (let ((deps (read-dependencies deps-filename)))
+         (and deps
+              (every up-to-date? deps)
+              (catch 'system-error
+                (lambda ()
+                  (copy-file* out-filename output-filename)
+                  (log! 'message
+                        (G_ "Netlist ~S restored from cache.")
+                        output-filename)
+                  #t)
+                (lambda (key . args) #f))))))
+
+
+(define (netlist-cache-store! cache-dir key output-filename dependencies)
+  "Stores OUTPUT-FILENAME in CACHE-DIR under KEY along with the
+checksums of DEPENDENCIES, which must be a list of file and
+directory names.  Missing files are recorded with the checksum #f.
+Failures are reported as warnings."
+  (define (dependency filename)
+    (cons filename (dependency-checksum filename)))
+
+  (define deps-filename (cache-filename cache-dir key ".deps"))
+
+  (catch 'system-error
+    (lambda ()
+      (unless (file-exists? cache-dir)
+        (mkdir cache-dir))
+      ;; Invalidate the entry before replacing the netlist so that
+      ;; an interrupted run never leaves a new netlist with stale
+      ;; dependencies or vice versa.
+      (when (file-exists? deps-filename)
+        (delete-file deps-filename))
+      (copy-file* output-filename (cache-filename cache-dir key ".out"))
+      (let* ((port (mkstemp! (string-append deps-filename ".XXXXXX")))
+             (tmp (port-filename port)))
+        (write (map dependency dependencies) port)
+        (newline port)
+        (close-port port)
+        (rename-file tmp deps-filename)))
+    (lambda (key subr message args rest)
+      (log! 'warning
+            (G_ "Failed to store netlist in cache directory ~S: ~?")
+            cache-dir
+            message
+            args))))
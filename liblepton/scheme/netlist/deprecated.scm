@@ -48,17 +48,11 @@
 (define print-gnetlist-config print-netlist-config)
 
 (define (get-pins refdes)
-  (define (found? x)
-    (and x
-         (string=? x refdes)))
-
   (sort-remove-duplicates
    (append-map
     (lambda (package)
-      (if (found? (schematic-component-refdes package))
-          (filter-map package-pin-number (schematic-component-pins package))
-          '()))
-    (schematic-components (toplevel-schematic)))
+      (filter-map package-pin-number (schematic-component-pins package)))
+    (schematic-refdes-components (toplevel-schematic) refdes))
    refdes<?))
 
 ;;; Alias for get-pins().
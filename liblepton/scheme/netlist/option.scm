@@ -33,11 +33,15 @@
   '((quiet . #f)
     (verbose . #f)
     (load-path . ())
-    (backend . #f)
+    (backend . ())
     (file-backend . #f)
     (backend-option . ())
     (list-backends . #f)
     (output . "output.net")
+    (cache-dir . #f)
+    (profile . #f)
+    (profile-format . #f)
+    (server . #f)
     (pre-load . ())
     (post-load . ())
     (eval-code . ())
@@ -0,0 +1,166 @@
+;;; Lepton EDA netlister
+;;; Copyright (C) 2022 Lepton EDA Contributors
+;;;
+;;; This program is free software; you can redistribute it and/or modify
+;;; it under the terms of the GNU General Public License as published by
+;;; the Free Software Foundation; either version 2 of the License, or
+;;; (at your option) any later version.
+;;;
+;;; This program is distributed in the hope that it will be useful,
+;;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;;; GNU General Public License for more details.
+;;;
+;;; You should have received a copy of the GNU General Public License
+;;; along with this program; if not, write to the Free Software
+;;; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+;;; Profiling of netlister phases.
+;;;
+;;; When the "--profile" option is given, every phase wrapped in
+;;; with-profile-phase() is measured, and a report on wall time,
+;;; garbage collection time, and allocated bytes for each phase is
+;;; output at exit.  Phases may be nested, in which case the time
+;;; of inner phases is included in the time of outer ones.
+
+(define-module (netlist profile)
+  #:use-module (ice-9 format)
+  #:use-module (srfi srfi-9)
+
+  #:use-module (netlist option)
+
+  #:export (profile-enabled?
+            call-with-profile-phase
+            with-profile-phase
+            profile-report))
+
+(define-record-type <profile-phase>
+  (make-profile-phase index name depth wall-time gc-time allocated)
+  profile-phase?
+  (index profile-phase-index)
+  (name profile-phase-name)
+  (depth profile-phase-depth)
+  (wall-time profile-phase-wall-time)
+  (gc-time profile-phase-gc-time)
+  (allocated profile-phase-allocated))
+
+;;; List of measured phases in reverse order of their completion.
+(define %profile-phases '())
+
+;;; Number of phases started so far.
+(define %profile-count 0)
+
+;;; Nesting level of the current phase.
+(define %profile-depth 0)
+
+
+(define (profile-enabled?)
+  "Returns #t if the \"--profile\" or \"--profile-format\" option
+is given."
+  (and (or (netlist-option-ref 'profile)
+           (netlist-option-ref 'profile-format))
+       #t))
+
+
+(define (gc-stats-ref key)
+  (or (assq-ref (gc-stats) key) 0))
+
+
+(define (internal-time->seconds time)
+  (exact->inexact (/ time internal-time-units-per-second)))
+
+
+(define (call-with-profile-phase name thunk)
+  "Calls THUNK and returns its result.  If profiling is enabled,
+records wall time, garbage collection time, and bytes allocated
+during the call as the phase NAME, which must be a string."
+  (if (not (profile-enabled?))
+      (thunk)
+      (let ((index %profile-count)
+            (depth %profile-depth)
+            (start-time (get-internal-real-time))
+            (start-gc-time (gc-stats-ref 'gc-time-taken))
+            (start-allocated (gc-stats-ref 'heap-total-allocated)))
+        (set! %profile-count (1+ index))
+        (set! %profile-depth (1+ depth))
+        (call-with-values thunk
+          (lambda results
+            (set! %profile-depth depth)
+            (set! %profile-phases
+                  (cons (make-profile-phase
+                         index
+                         name
+                         depth
+                         (internal-time->seconds
+                          (- (get-internal-real-time) start-time))
+                         (internal-time->seconds
+                          (- (gc-stats-ref 'gc-time-taken) start-gc-time))
+                         (- (gc-stats-ref 'heap-total-allocated)
+                            start-allocated))
+                        %profile-phases))
+            (apply values results))))))
+
+
+(define-syntax-rule (with-profile-phase name body ...)
+  (call-with-profile-phase name (lambda () body ...)))
+
+
+(define (write-json-string s port)
+  (write-char #\" port)
+  (string-for-each
+   (lambda (c)
+     (case c
+       ((#\") (display "\\\"" port))
+       ((#\\) (display "\\\\" port))
+       ((#\newline) (display "\\n" port))
+       (else (write-char c port))))
+   s)
+  (write-char #\" port))
+
+
+(define (report-text phases port)
+  (format port "~40A ~10@A ~10@A ~14@A\n"
+          "Phase" "Wall, s" "GC, s" "Allocated, B")
+  (for-each
+   (lambda (phase)
+     (format port "~40A ~10,3F ~10,3F ~14D\n"
+             (string-append (make-string (* 2 (profile-phase-depth phase))
+                                         #\space)
+                            (profile-phase-name phase))
+             (profile-phase-wall-time phase)
+             (profile-phase-gc-time phase)
+             (profile-phase-allocated phase)))
+   phases))
+
+
+(define (report-json phases port)
+  (display "[" port)
+  (let loop ((phases phases) (first? #t))
+    (unless (null? phases)
+      (let ((phase (car phases)))
+        (unless first? (display "," port))
+        (display "\n  {\"phase\": " port)
+        (write-json-string (profile-phase-name phase) port)
+        (format port ", \"depth\": ~D, \"wall\": ~,6F, \"gc\": ~,6F, \"allocated\": ~D}"
+                (profile-phase-depth phase)
+                (profile-phase-wall-time phase)
+                (profile-phase-gc-time phase)
+                (profile-phase-allocated phase))
+        (loop (cdr phases) #f))))
+  (display "\n]\n" port))
+
+
+(define* (profile-report #:optional (port (current-error-port)))
+  "Outputs the profile of all phases measured so far to PORT,
+which defaults to the current error port.  The report is output
+in JSON if the value of the \"--profile-format\" option is \"json\",
+otherwise it is output as a text table."
+  (when (profile-enabled?)
+    ((if (equal? (netlist-option-ref 'profile-format) "json")
+         report-json
+         report-text)
+     ;; Output phases in the order they were started.
+     (sort %profile-phases
+           (lambda (a b)
+             (< (profile-phase-index a) (profile-phase-index b))))
+     port)))
@@ -101,35 +101,78 @@ Example usage:
                  (_ #\?)))
              args)))))
 
-;;; This is a helper object property to get object connections
-;;; once.
-(define object-conns (make-object-property))
-
-(define (connected-to? object1 object2)
-  (not (not (memv object1 (object-conns object2)))))
-
-(define (connected-to-ls? object1 ls)
-  (and (not (null? ls))
-       (or (connected-to? object1 (car ls))
-           (connected-to-ls? object1 (cdr ls)))))
-
-(define (reconnect-groups object groups)
-  (define (object-connected-to? group)
-    (connected-to-ls? object group))
-
-  (receive (connected unconnected)
-      (partition object-connected-to? groups)
-    (let ((result
-           `(,@unconnected
-             ,(if (null? connected)
-                  (list object)
-                  (apply append (list object) connected)))))
-      result)))
-
 ;;; Transforms list of objects LS into the list of lists of
 ;;; interconnected objects.
+;;;
+;;; Objects are processed in the order of LS using a union-find
+;;; structure over their indices.  The root of every group is its
+;;; latest processed object.  When an object joins several groups,
+;;; they are recorded as its children in the order of their roots.
+;;; Groups are output in the order of their roots, each one as the
+;;; root followed by its children groups, recursively.  The result
+;;; is the same as merging groups in a fold over LS, in which each
+;;; new group is appended to the end of the group list.
 (define (group-connections ls)
-  (fold reconnect-groups '() ls))
+  (define objects (list->vector ls))
+  (define count (vector-length objects))
+  (define parents (make-vector count 0))
+  (define children (make-vector count '()))
+  (define indexes (make-hash-table count))
+
+  (define (find index)
+    (let ((root (let loop ((i index))
+                  (let ((parent (vector-ref parents i)))
+                    (if (= parent i) i (loop parent))))))
+      ;; Path compression.
+      (let loop ((i index))
+        (let ((parent (vector-ref parents i)))
+          (unless (= parent root)
+            (vector-set! parents i root)
+            (loop parent))))
+      root))
+
+  ;; Returns the sorted list of roots of the groups the object
+  ;; with INDEX is connected to.
+  (define (connected-roots index)
+    (sort
+     (delete-duplicates
+      (filter-map
+       (lambda (object)
+         (let ((i (hashq-ref indexes object)))
+           (and i
+                (< i index)
+                (find i))))
+       (object-connections (vector-ref objects index))))
+     <))
+
+  (define (group-objects root)
+    (let loop ((stack (list root))
+               (result '()))
+      (if (null? stack)
+          (reverse! result)
+          (let ((i (car stack)))
+            (loop (append (vector-ref children i) (cdr stack))
+                  (cons (vector-ref objects i) result))))))
+
+  (do ((i 0 (1+ i)))
+      ((= i count))
+    (hashq-set! indexes (vector-ref objects i) i))
+
+  (do ((i 0 (1+ i)))
+      ((= i count))
+    (let ((roots (connected-roots i)))
+      (vector-set! parents i i)
+      (for-each (cut vector-set! parents <> i) roots)
+      (vector-set! children i roots)))
+
+  (let loop ((i (1- count))
+             (groups '()))
+    (if (< i 0)
+        groups
+        (loop (1- i)
+              (if (= i (vector-ref parents i))
+                  (cons (group-objects i) groups)
+                  groups)))))
 
 
 (define (schematic-connection->netnames schematic-connection)
@@ -198,13 +241,7 @@ Example usage:
                       (cons object components)
                       components))))))
 
-  (define (populate-object-connections object)
-    (set! (object-conns object)
-          (object-connections object)))
-
   (let-values (((nets pins) (page-connectable-objects page)))
-    (for-each populate-object-connections nets)
-    (for-each populate-object-connections pins)
     (map (cut get-schematic-connection page <>)
          (connections->netname-groups
           (group-connections (append nets pins))))))
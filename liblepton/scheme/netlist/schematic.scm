@@ -38,6 +38,7 @@
   #:use-module (netlist schematic-port)
   #:use-module (netlist subschematic)
   #:use-module (netlist package-pin)
+  #:use-module (netlist profile)
 
   #:export-syntax (make-schematic schematic?
                    schematic-id set-schematic-id!
@@ -59,6 +60,10 @@
             schematic-non-unique-package-names
             schematic-package-names
             schematic-pins
+            schematic-netname-pins
+            schematic-refdes-components
+            schematic-refdes-pinnumber-pins
+            schematic-refdes-pin-attrib-pins
             schematic-ports
             schematic-tree
             schematic-name-tree
@@ -75,7 +80,11 @@
                   non-unique-nets
                   nets
                   nc-nets
-                  connections)
+                  connections
+                  netname-index
+                  refdes-index
+                  pin-index
+                  pin-attrib-index)
   schematic?
   (id schematic-id set-schematic-id!)
   (subschematic schematic-subschematic set-schematic-subschematic!)
@@ -87,7 +96,14 @@
   (non-unique-nets schematic-non-unique-nets set-schematic-non-unique-nets!)
   (nets schematic-nets set-schematic-nets!)
   (nc-nets schematic-nc-nets set-schematic-nc-nets!)
-  (connections schematic-connections set-schematic-connections!))
+  (connections schematic-connections set-schematic-connections!)
+  ;; Hash tables for fast lookup of components and pins by
+  ;; netname, refdes, (refdes . pinnumber), and (refdes
+  ;; pin-attrib-name . value).
+  (netname-index schematic-netname-index)
+  (refdes-index schematic-refdes-index)
+  (pin-index schematic-pin-index)
+  (pin-attrib-index schematic-pin-attrib-index))
 
 (set-record-type-printer!
  <schematic>
@@ -244,17 +260,100 @@
   (filter-map toplevel-attrib? (append-map page-contents toplevel-pages)))
 
 
-;;; Returns #t if NETNAME is a "no-connect" net, that is, one of
-;;; its connected symbols is one of PACKAGES and a "no-connect"
-;;; symbol. Otherwise returns #f.
-(define (nc-net? netname packages)
-  (define (pin-netname-matches? pin)
-    (string=? (package-pin-name pin) netname))
+;;; Returns a hash table containing the net names of all pins of
+;;; PACKAGES, which are supposed to be "no-connect" symbols.
+(define (make-nc-netname-table packages)
+  (define table (make-hash-table))
+
+  (for-each
+   (lambda (package)
+     (for-each (lambda (pin) (hash-set! table (package-pin-name pin) #t))
+               (schematic-component-pins package)))
+   packages)
+  table)
 
-  (define (wanted-package-pin-netname=? package)
-    (any pin-netname-matches? (schematic-component-pins package)))
 
-  (any wanted-package-pin-netname=? packages))
+;;; Returns #t if NETNAME is a "no-connect" net, that is, one of
+;;; its connected symbols is a "no-connect" symbol whose pin net
+;;; names are in NC-NETNAMES, a table made by
+;;; make-nc-netname-table().  Otherwise returns #f.
+(define (nc-net? netname nc-netnames)
+  (hash-ref nc-netnames netname #f))
+
+
+;;; Builds hash tables indexing COMPONENTS and their pins.  Returns
+;;; three values: the table of pins by their net names, the table
+;;; of components by their refdeses, and the table of pins by
+;;; pairs (refdes . pinnumber).  The values of each table are
+;;; lists in the order of COMPONENTS and their pins.
+(define (make-schematic-indexes components)
+  (define netname-index (make-hash-table 1024))
+  (define refdes-index (make-hash-table 1024))
+  (define pin-index (make-hash-table 1024))
+  (define pin-attrib-index (make-hash-table 1024))
+
+  (define (add! table key value)
+    (let ((handle (hash-create-handle! table key '())))
+      (set-cdr! handle (cons value (cdr handle)))))
+
+  (define (reverse-values! table)
+    (hash-for-each-handle
+     (lambda (handle) (set-cdr! handle (reverse! (cdr handle))))
+     table))
+
+  (define (add-pin! refdes pin)
+    (let ((netname (package-pin-name pin))
+          (pinnumber (package-pin-number pin)))
+      (when (string? netname)
+        (add! netname-index netname pin))
+      (when (and refdes pinnumber)
+        (add! pin-index (cons refdes pinnumber) pin))))
+
+  ;; For every component, only the first pin having a given
+  ;; "pinnumber=" or "pinseq=" value is added.  Artificial pins
+  ;; having a pin number but no "pinnumber=" attribute are added
+  ;; for the numbers no real pin of the component has.
+  (define (add-pin-attribs! refdes pins)
+    (define seen (make-hash-table))
+
+    (define (add-once! name value pin)
+      (let ((key (list refdes name value)))
+        (unless (hash-ref seen key)
+          (hash-set! seen key #t)
+          (add! pin-attrib-index key pin))))
+
+    (for-each
+     (lambda (pin)
+       (for-each
+        (lambda (name)
+          (let ((value (assq-ref (package-pin-attribs pin) name)))
+            (when value
+              (add-once! name value pin))))
+        '(pinnumber pinseq)))
+     pins)
+    (for-each
+     (lambda (pin)
+       (let ((pinnumber (package-pin-number pin)))
+         (when pinnumber
+           (add-once! 'pinnumber pinnumber pin))))
+     pins))
+
+  (for-each
+   (lambda (component)
+     (let ((refdes (schematic-component-refdes component))
+           (pins (schematic-component-pins component)))
+       (when refdes
+         (add! refdes-index refdes component)
+         (add-pin-attribs! refdes pins))
+       (for-each (cut add-pin! refdes <>) pins)))
+   components)
+
+  (reverse-values! netname-index)
+  (reverse-values! refdes-index)
+  (reverse-values! pin-index)
+  (reverse-values! pin-attrib-index)
+
+  (values netname-index refdes-index pin-index pin-attrib-index))
 
 
 (define (collect-components-recursively subschematic)
@@ -274,39 +373,56 @@ of schematic pages."
   (let* ((id (next-schematic-id))
          (toplevel-attribs (get-toplevel-attributes pages))
          ;; '() is toplevel hierarchy tag
-         (subschematic (page-list->hierarchical-subschematic pages '()))
+         (subschematic
+          (with-profile-phase "subschematics"
+            (page-list->hierarchical-subschematic pages '())))
          (components (collect-components-recursively subschematic))
-         (connections (make-hierarchical-connections subschematic))
-         (full-netlist (hierarchy-post-process components connections))
+         (connections
+          (with-profile-phase "hierarchical connections"
+            (make-hierarchical-connections subschematic)))
+         (full-netlist
+          (with-profile-phase "hierarchy post-processing"
+            (hierarchy-post-process components connections)))
          (netlist (filter plain-package? full-netlist))
-         (packages (make-package-list netlist))
-         (graphicals (filter schematic-component-graphical? full-netlist))
-         (nu-nets (get-all-nets netlist))
-         (unique-nets (get-nets netlist)))
-    ;; Partition all unique net names into 'no-connection' nets
-    ;; and plain nets.
-    (receive (nc-nets nets)
-        (partition (lambda (x)
-                     (nc-net? x (filter schematic-component-nc? full-netlist)))
-                   unique-nets)
-      (make-schematic id
-                      subschematic
-                      pages
-                      toplevel-attribs
-                      netlist
-                      packages
-                      graphicals
-                      nu-nets
-                      nets
-                      nc-nets
-                      connections
-                      ))))
+         (packages
+          (with-profile-phase "package list"
+            (make-package-list netlist)))
+         (graphicals (filter schematic-component-graphical? full-netlist)))
+    (receive (nu-nets nets nc-nets)
+        (with-profile-phase "net names"
+          (let ((unique-nets (get-nets netlist))
+                (nc-netnames (make-nc-netname-table
+                              (filter schematic-component-nc? full-netlist))))
+            ;; Partition all unique net names into 'no-connection'
+            ;; nets and plain nets.
+            (receive (nc-nets nets)
+                (partition (cut nc-net? <> nc-netnames) unique-nets)
+              (values (get-all-nets netlist) nets nc-nets))))
+      (receive (netname-index refdes-index pin-index pin-attrib-index)
+          (with-profile-phase "schematic indexes"
+            (make-schematic-indexes netlist))
+        (make-schematic id
+                        subschematic
+                        pages
+                        toplevel-attribs
+                        netlist
+                        packages
+                        graphicals
+                        nu-nets
+                        nets
+                        nc-nets
+                        connections
+                        netname-index
+                        refdes-index
+                        pin-index
+                        pin-attrib-index)))))
 
 
 (define (file-name-list->schematic filenames)
   "Creates a new schematic record from FILENAMES, which must be a
 list of strings representing file names."
-  (let ((pages (map file->page filenames)))
+  (let ((pages (with-profile-phase "page parsing"
+                 (map file->page filenames))))
     (page-list->schematic pages)))
 
 
@@ -337,3 +453,33 @@ list of strings representing file names."
   "Returns a list of all component pins in SCHEMATIC."
   (append-map schematic-component-pins
               (schematic-components schematic)))
+
+
+(define (schematic-netname-pins schematic netname)
+  "Returns the list of pins of SCHEMATIC components having the net
+name NETNAME."
+  (hash-ref (schematic-netname-index schematic) netname '()))
+
+
+(define (schematic-refdes-components schematic refdes)
+  "Returns the list of SCHEMATIC components having the refdes
+REFDES."
+  (hash-ref (schematic-refdes-index schematic) refdes '()))
+
+
+(define (schematic-refdes-pinnumber-pins schematic refdes pinnumber)
+  "Returns the list of pins having the pin number PINNUMBER of
+SCHEMATIC components having the refdes REFDES."
+  (hash-ref (schematic-pin-index schematic) (cons refdes pinnumber) '()))
+
+
+(define (schematic-refdes-pin-attrib-pins schematic refdes name value)
+  "Returns the list of pins of SCHEMATIC components having the
+refdes REFDES whose attribute NAME, which must be either
+'pinnumber or 'pinseq, has the value VALUE.  The list contains at
+most one pin for each component, in the order of components.  If
+NAME is 'pinnumber, artificial pins having the pin number VALUE
+are returned for components having no real pin with that number."
+  (hash-ref (schematic-pin-attrib-index schematic)
+            (list refdes name value)
+            '()))
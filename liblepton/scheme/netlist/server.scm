@@ -0,0 +1,401 @@
+;;; Lepton EDA netlister
+;;; Copyright (C) 2022 Lepton EDA Contributors
+;;;
+;;; This program is free software; you can redistribute it and/or modify
+;;; it under the terms of the GNU General Public License as published by
+;;; the Free Software Foundation; either version 2 of the License, or
+;;; (at your option) any later version.
+;;;
+;;; This program is distributed in the hope that it will be useful,
+;;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;;; GNU General Public License for more details.
+;;;
+;;; You should have received a copy of the GNU General Public License
+;;; along with this program; if not, write to the Free Software
+;;; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+;;; Netlist server.
+;;;
+;;; In server mode, lepton-netlist listens on a local UNIX socket
+;;; and processes requests one by one.  rc files are loaded, and
+;;; symbol libraries are set up only once, and are loaded again in
+;;; a new toplevel only if any of the rc files read so far has
+;;; changed.  Schematic pages, including hierarchical sub-sheets,
+;;; are kept loaded between requests and are reloaded only if their
+;;; files or the symbol files they use have changed.  Every request
+;;; is served by a forked child process that inherits the loaded
+;;; data, so errors in backends never affect the server.
+;;;
+;;; A request is a Scheme alist written to the socket:
+;;;
+;;;   ((cwd . "/path/to/project")
+;;;    (args "-g" "geda" "schematic.sch"))
+;;;
+;;; where 'args are lepton-netlist command line arguments, and
+;;; 'cwd is the directory relative file names are resolved against.
+;;; If the arguments do not contain the "-o" option, the netlist is
+;;; written back to the socket.  Otherwise, it is written to the
+;;; given file.  In either case, the response ends with a line
+;;; "OK" or "ERROR CODE" where CODE is the exit status of the
+;;; netlister, and the server closes the connection when the
+;;; request is done.  A request that is not received within
+;;; %request-timeout seconds is dropped.
+
+(define-module (netlist server)
+  #:use-module (ice-9 binary-ports)
+  #:use-module (ice-9 getopt-long)
+  #:use-module (rnrs bytevectors)
+  #:use-module (srfi srfi-1)
+
+  #:use-module ((lepton ffi) #:select (s_clib_flush_symbol_cache))
+  #:use-module (lepton gettext)
+  #:use-module (lepton library)
+  #:use-module (lepton log)
+  #:use-module (lepton object)
+  #:use-module (lepton os)
+  #:use-module (lepton page)
+  #:use-module (lepton rc)
+  #:use-module (lepton toplevel)
+  #:use-module (netlist)
+  #:use-module (netlist option)
+  #:use-module (netlist schematic-component)
+  #:use-module (netlist subschematic)
+
+  #:export (netlist-server))
+
+;;; Table of loaded toplevel pages by their file names.
+(define %toplevel-pages (make-hash-table))
+
+;;; Table of sub-sheet pages by their file names.  It is shared
+;;; with (netlist subschematic) through source-page-cache().
+(define %source-pages (make-hash-table))
+
+;;; Stamps of loaded page files.  Every value is a pair of the
+;;; stamp of the page file and an alist of the symbol files used on
+;;; the page and their stamps.
+(define %stamps (make-hash-table))
+
+;;; Stamps of the rc files read so far by their file names,
+;;; including the files that did not exist.
+(define %rc-stamps (make-hash-table))
+
+;;; Table of schematic directories whose rc files have been loaded.
+(define %rc-directories (make-hash-table))
+
+;;; Number of seconds a client is given to send its request.
+(define %request-timeout 10)
+
+
+(define (file-stamp filename)
+  "Returns a value that changes whenever FILENAME is modified:
+the list of its modification time with nanoseconds and its size,
+or #f if the file does not exist."
+  (catch 'system-error
+    (lambda ()
+      (let ((st (stat filename)))
+        (list (stat:mtime st) (stat:mtimensec st) (stat:size st))))
+    (lambda (key . args) #f)))
+
+
+(define (up-to-date? dependency)
+  (equal? (file-stamp (car dependency)) (cdr dependency)))
+
+
+(define (page-symbol-stamps page)
+  (map (lambda (filename) (cons filename (file-stamp filename)))
+       (delete-duplicates
+        (filter-map component-filename
+                    (filter component? (page-contents page))))))
+
+
+(define (ensure-page! table filename)
+  "Returns the page for FILENAME from TABLE, loading it if it has
+not been loaded yet or if the file or any symbol file used on it
+has changed since then."
+  (let ((page (hash-ref table filename))
+        (stamps (hash-ref %stamps filename))
+        (stamp (file-stamp filename)))
+    (if (and page
+             stamps
+             (equal? stamp (car stamps))
+             (every up-to-date? (cdr stamps)))
+        page
+        (begin
+          (when page
+            (hash-remove! table filename)
+            (close-page! page))
+          ;; Symbols are cached by the library, so drop them to
+          ;; read the changed ones again.
+          (when (and stamps
+                     (not (every up-to-date? (cdr stamps))))
+            (s_clib_flush_symbol_cache))
+          (let ((page (file->page filename 'new-page)))
+            (hash-set! table filename page)
+            (hash-set! %stamps filename
+                       (cons stamp (page-symbol-stamps page)))
+            page)))))
+
+
+(define (ensure-source-pages! page visited)
+  "Loads sub-sheets of components on PAGE recursively.  VISITED is
+a hash table of already processed file names."
+  (define (component-sources object)
+    (or (schematic-component-sources
+         (component->schematic-component object))
+        '()))
+
+  (for-each
+   (lambda (name)
+     (let ((filename (get-source-library-file name)))
+       (when (and filename (not (hash-ref visited filename)))
+         (hash-set! visited filename #t)
+         (ensure-source-pages! (ensure-page! %source-pages filename)
+                               visited))))
+   (append-map component-sources
+               (filter component? (page-contents page)))))
+
+
+(define (request-ref request key)
+  (and (list? request)
+       (assq-ref request key)))
+
+
+(define (schematic-file-names options)
+  (map canonicalize-path
+       (filter file-exists? (option-ref options '() '()))))
+
+
+(define (rc-file-names directory rc-name)
+  "Returns the names of the system, user, and local rc files read
+for DIRECTORY by parse-rc() with RC-NAME, whether they exist or
+not."
+  (append-map
+   (lambda (name)
+     (append (map (lambda (dir) (string-append dir "/system-" name))
+                  (sys-config-dirs))
+             (list (string-append (user-config-dir) "/" name)
+                   (string-append directory "/" name))))
+   (delete-duplicates (list "gafrc" rc-name))))
+
+
+(define (load-rc! directory rc-name)
+  "Loads rc files with RC-NAME for DIRECTORY unless they have been
+loaded already, and records their stamps."
+  (unless (hash-ref %rc-directories directory)
+    (let ((cwd (getcwd)))
+      (chdir directory)
+      (parse-rc "lepton-netlist" rc-name)
+      (chdir cwd))
+    (hash-set! %rc-directories directory #t)
+    (for-each (lambda (filename)
+                (hash-set! %rc-stamps filename (file-stamp filename)))
+              (rc-file-names directory rc-name))))
+
+
+(define (rc-files-changed?)
+  (not (every up-to-date? (hash-map->list cons %rc-stamps))))
+
+
+(define (reset-server!)
+  "Drops all loaded pages and libraries, and loads rc files again
+in a new toplevel, so that changes in rc files take effect.  rc
+files are only read once in a toplevel, so the old one cannot be
+reused."
+  (log! 'message (G_ "rc files have changed, reloading them."))
+  (for-each (lambda (table)
+              (hash-for-each (lambda (filename page) (close-page! page))
+                             table)
+              (hash-clear! table))
+            (list %toplevel-pages %source-pages))
+  (hash-clear! %stamps)
+  (hash-clear! %rc-stamps)
+  (hash-clear! %rc-directories)
+  (reset-component-library)
+  (reset-source-library)
+  (set-current-toplevel! (make-toplevel))
+  (load-rc! (getcwd) "gnetlistrc"))
+
+
+(define (preload-request! options)
+  "Loads gafrc files and pages needed for the request with parsed
+OPTIONS into the server process."
+  (let ((files (schematic-file-names options))
+        (visited (make-hash-table)))
+    (for-each (lambda (filename)
+                (load-rc! (dirname filename) "gafrc"))
+              files)
+    (for-each (lambda (filename)
+                (ensure-source-pages! (ensure-page! %toplevel-pages filename)
+                                      visited))
+              files)))
+
+
+(define (exit-status status)
+  (or (status:exit-val status)
+      (+ 128 (status:term-sig status))))
+
+
+(define (read-request client)
+  "Reads a request from CLIENT.  Returns #f if no complete request
+has been received within %request-timeout seconds, so that a
+client that sends nothing cannot stall the server."
+  (define deadline (+ (current-time) %request-timeout))
+
+  ;; Returns the request read from CHUNKS, the list of bytevectors
+  ;; received so far in reverse order, or #f if it is incomplete.
+  (define (parse-request chunks)
+    (catch #t
+      (lambda ()
+        (let ((request
+               (read (open-input-string
+                      (utf8->string
+                       (u8-list->bytevector
+                        (append-map bytevector->u8-list
+                                    (reverse chunks))))))))
+          (and (not (eof-object? request))
+               request)))
+      (lambda (key . args) #f)))
+
+  (let loop ((chunks '()))
+    (let ((timeout (- deadline (current-time))))
+      (and (positive? timeout)
+           (not (null? (car (select (list client) '() '() timeout))))
+           (let ((chunk (get-bytevector-some client)))
+             (if (eof-object? chunk)
+                 (parse-request chunks)
+                 (let ((chunks (cons chunk chunks)))
+                   (or (parse-request chunks)
+                       (loop chunks)))))))))
+
+
+(define (copy-output! in out)
+  "Copies everything from port IN to port OUT.  Returns #t if the
+data copied are empty or end with a newline."
+  (let loop ((newline? #t))
+    (let ((chunk (get-bytevector-some in)))
+      (if (eof-object? chunk)
+          newline?
+          (begin
+            (put-bytevector out chunk)
+            (loop (= (bytevector-u8-ref chunk
+                                        (1- (bytevector-length chunk)))
+                     (char->integer #\newline))))))))
+
+
+(define (send-status! client status)
+  "Ends the response to CLIENT with a line \"OK\" if STATUS is
+zero, or \"ERROR STATUS\" otherwise.  Errors are ignored since the
+client may have gone."
+  (false-if-exception
+   (if (zero? status)
+       (display "OK\n" client)
+       (format client "ERROR ~A\n" status))))
+
+
+(define (serve-request! client request option-spec)
+  (define cwd (request-ref request 'cwd))
+  (define args (request-ref request 'args))
+
+  (define (canonical-file-names options)
+    ;; Canonical names let the netlister find the pages loaded by
+    ;; the server.  Missing files are reported by the netlister.
+    (map (lambda (filename)
+           (if (file-exists? filename)
+               (canonicalize-path filename)
+               filename))
+         (option-ref options '() '())))
+
+  (define (run-netlister options stream? port)
+    (catch #t
+      (lambda ()
+        (init-netlist-options! options)
+        (set-netlist-option! '() (canonical-file-names options))
+        (when stream?
+          (set-netlist-option! 'output "-"))
+        (parameterize ((source-page-cache %source-pages))
+          (with-output-to-port port main))
+        (force-output port)
+        (primitive-exit 0))
+      (lambda (key . args)
+        (log! 'critical
+              (G_ "Failed to process netlist server request: ~A ~S")
+              key args)
+        (primitive-exit 1))))
+
+  ;; Runs the netlister in a forked child process, relays its
+  ;; output to the client, and returns its exit status.  The
+  ;; output goes through a pipe so that the status line can always
+  ;; be put on a line of its own after it.
+  (define (run-request options stream?)
+    (let* ((ports (pipe))
+           (pid (primitive-fork)))
+      (if (zero? pid)
+          (begin
+            (close-port (car ports))
+            (run-netlister options stream? (cdr ports)))
+          (let ((status #f))
+            (close-port (cdr ports))
+            (dynamic-wind
+              (const #t)
+              (lambda ()
+                (unless (copy-output! (car ports) client)
+                  (newline client)))
+              (lambda ()
+                (close-port (car ports))
+                (set! status (exit-status (cdr (waitpid pid))))))
+            status))))
+
+  (if (not (and (string? cwd)
+                (list? args)
+                (every string? args)))
+      (begin
+        (log! 'warning (G_ "Invalid netlist server request: ~S") request)
+        (send-status! client 1))
+      (let ((server-cwd (getcwd)))
+        (catch #t
+          (lambda ()
+            (chdir cwd)
+            (let* ((options (getopt-long (cons "lepton-netlist" args)
+                                         option-spec))
+                   (stream? (string=? (option-ref options 'output "-") "-")))
+              (preload-request! options)
+              (send-status! client (run-request options stream?))))
+          (lambda (key . args)
+            (log! 'warning
+                  (G_ "Failed to process netlist server request ~S: ~A ~S")
+                  request key args)
+            (send-status! client 1)))
+        (chdir server-cwd))))
+
+
+(define (netlist-server socket-path option-spec)
+  "Runs netlist server listening on the UNIX socket SOCKET-PATH.
+OPTION-SPEC is the getopt-long specification of lepton-netlist
+command line options used to parse requests."
+  (define sock (socket PF_UNIX SOCK_STREAM 0))
+
+  ;; Load rc files and set up libraries.  They are loaded again
+  ;; by reset-server!() only if any of the rc files changes.
+  (load-rc! (getcwd) "gnetlistrc")
+
+  ;; Writing to a client that has gone must raise an error rather
+  ;; than kill the server.
+  (sigaction SIGPIPE SIG_IGN)
+
+  (when (file-exists? socket-path)
+    (delete-file socket-path))
+  (bind sock AF_UNIX socket-path)
+  (listen sock 5)
+  (log! 'message (G_ "Netlist server is listening on ~S.") socket-path)
+
+  (let loop ()
+    (let* ((client (car (accept sock)))
+           (request (catch #t
+                      (lambda () (read-request client))
+                      (lambda (key . args) #f))))
+      (when (rc-files-changed?)
+        (reset-server!))
+      (serve-request! client request option-spec)
+      (close-port client))
+    (loop)))
@@ -50,6 +50,7 @@
                    subschematic-connections set-subschematic-connections!)
 
   #:export (page-list->hierarchical-subschematic
+            source-page-cache
             schematic-component-ports
             make-hierarchical-connections
             make-hierarchical-connection-name))
@@ -70,17 +71,30 @@
                           "#<subschematic-~A>"
                           (subschematic-name record))))
 
-(define (get-package-pin-connection pin-object connections)
-  (let loop ((groups connections))
-    (and (not (null? groups))
-         (let ((group (car groups)))
-           (or (and (member pin-object (schematic-connection-objects group)) group)
-               (loop (cdr groups)))))))
+;;; Returns a hash table mapping every object of CONNECTIONS to
+;;; the first connection containing it.
+(define (make-object-connection-table connections)
+  (define table (make-hash-table 1024))
+
+  (define (add-object! connection object)
+    (unless (hashq-ref table object)
+      (hashq-set! table object connection)))
+
+  (for-each
+   (lambda (connection)
+     (for-each (cut add-object! connection <>)
+               (schematic-connection-objects connection)))
+   connections)
+  table)
 
 
-(define (set-real-package-pin-connection! pin connections)
+(define (get-package-pin-connection pin-object connection-table)
+  (hashq-ref connection-table pin-object))
+
+
+(define (set-real-package-pin-connection! pin connection-table)
   (let ((connection (get-package-pin-connection (package-pin-object pin)
-                                                connections)))
+                                                connection-table)))
     (schematic-connection-add-pin! connection pin)
     pin))
 
@@ -121,14 +135,16 @@
     (schematic-connection-add-pin! connection pin)))
 
 
-(define (set-package-pin-connection-properties! component connections)
+(define (set-package-pin-connection-properties! component
+                                                connections
+                                                connection-table)
   (define (real-pin? pin)
     (package-pin-object pin))
 
   (define (set-connection-properties! pin)
-    ((if (real-pin? pin)
-         set-real-package-pin-connection!
-         set-net-map-package-pin-connection!) pin connections))
+    (if (real-pin? pin)
+        (set-real-package-pin-connection! pin connection-table)
+        (set-net-map-package-pin-connection! pin connections)))
 
   (for-each set-connection-properties! (schematic-component-pins component)))
 
@@ -136,6 +152,7 @@
 (define (page->subschematic page)
   "Creates a new subschematic record from PAGE."
   (let* ((connections (make-page-schematic-connections page))
+         (connection-table (make-object-connection-table connections))
          (components (map component->schematic-component
                           (filter component? (page-contents page))))
          (subschematic
@@ -155,7 +172,7 @@
     (for-each (cut set-schematic-component-parent! <> subschematic)
               components)
     (for-each
-     (cut set-package-pin-connection-properties! <> connections)
+     (cut set-package-pin-connection-properties! <> connections connection-table)
      components)
 
     subschematic))
@@ -205,15 +222,33 @@ NAME is used as its hierarchical name."
     subschematic))
 
 
+;;; Hash table of source pages loaded while building the current
+;;; hierarchy, keyed by file name.  Each sub-sheet is read only
+;;; once and its page is shared by all components referring to it.
+;;; Every instance still gets its own subschematic records with
+;;; its own hierarchy tag.  If the parameter is bound to a table
+;;; before the hierarchy is built, pages from the table are reused,
+;;; which allows keeping sub-sheets loaded between netlister runs.
+(define source-page-cache (make-parameter #f))
+
+
 (define (hierarchy-down-schematic name)
   (define quiet-mode (netlist-option-ref 'quiet))
 
+  (define (load-source-page filename)
+    (unless quiet-mode
+      (log! 'message (G_ "Loading subcircuit ~S.") filename))
+    (file->page filename 'new-page))
+
   (let ((filename (get-source-library-file name)))
     (if filename
-        (begin
-          (unless quiet-mode
-            (log! 'message (G_ "Loading subcircuit ~S.") filename))
-          (file->page filename 'new-page))
+        (let ((cache (source-page-cache)))
+          (if cache
+              (or (hash-ref cache filename)
+                  (let ((page (load-source-page filename)))
+                    (hash-set! cache filename page)
+                    page))
+              (load-source-page filename)))
         (begin
           (log! 'critical (G_ "Failed to load subcircuit ~S.") name)
           #f))))
@@ -232,13 +267,21 @@ NAME is used as its hierarchical name."
            (set-subschematic-parent! subschematic component)
            component)))
 
-  (let ((subschematic (page-list->subschematic pages hierarchy-tag)))
-    ;; Traverse pages obtained from files defined in the 'source='
-    ;; attributes of schematic components.
-    (for-each traverse-component-sources
-              (subschematic-components subschematic))
+  (define (make-hierarchical-subschematic)
+    (let ((subschematic (page-list->subschematic pages hierarchy-tag)))
+      ;; Traverse pages obtained from files defined in the 'source='
+      ;; attributes of schematic components.
+      (for-each traverse-component-sources
+                (subschematic-components subschematic))
+
+      subschematic))
+
+  ;; The cache of source pages lives as long as the toplevel call.
+  (if (source-page-cache)
+      (make-hierarchical-subschematic)
+      (parameterize ((source-page-cache (make-hash-table)))
+        (make-hierarchical-subschematic))))
 
-    subschematic))
 (define (warn-no-pinlabel pin)
   (or (package-pin-label pin)
       (begin
@@ -107,8 +107,55 @@
 (test-end "object-connection-functions")
 
 
+;;; Test net IDs.
+(let ((P (make-page "/test/page/C"))
+      (C (make-component "test component" '(0 . 0) 0 #t #f))
+      (p1 (make-net-pin '(100 . 0) '(0 . 0)))
+      (p2 (make-net-pin '(100 . 200) '(0 . 200)))
+      (n1 (make-net '(100 . 0) '(100 . 100)))
+      (n2 (make-net '(100 . 100) '(200 . 100)))
+      (n3 (make-net '(100 . 200) '(200 . 200)))
+      (n4 (make-net '(200 . 100) '(200 . 200)))
+      (l (make-line '(0 . 0) '(100 . 100))))
+
+  (test-group-with-cleanup "object-net-id"
+
+    (test-assert-thrown 'object-state (object-net-id n1))
+
+    (component-append! C p1 p2)
+    (page-append! P C n1 n2 n3 l)
+
+    ;; Objects that are not pins, nets or buses have no net.
+    (test-eq #f (object-net-id C))
+    (test-eq #f (object-net-id l))
+
+    ;; Two separate nets.
+    (test-assert (object-net-id p1))
+    (test-equal (object-net-id p1) (object-net-id n1))
+    (test-equal (object-net-id p1) (object-net-id n2))
+    (test-equal (object-net-id p2) (object-net-id n3))
+    (test-assert (not (equal? (object-net-id p1) (object-net-id p2))))
+
+    ;; Join them.
+    (page-append! P n4)
+    (test-equal (object-net-id p1) (object-net-id p2))
+    (test-equal (object-net-id p1) (object-net-id n4))
+
+    ;; Split them again.  The net containing the object with the
+    ;; least ID keeps its ID.
+    (let ((id (object-net-id p1)))
+      (page-remove! P n4)
+      (test-equal id (object-net-id p1))
+      (test-equal (object-net-id p2) (object-net-id n3))
+      (test-assert (not (equal? (object-net-id p1) (object-net-id p2)))))
+
+    ;; Clean up.
+    (close-page! P)))
+
+
 (test-begin "object-connections-wrong-argument")
 
 (test-assert-thrown 'wrong-type-arg (object-connections 'x))
+(test-assert-thrown 'wrong-type-arg (object-net-id 'x))
 
 (test-end "object-connections-wrong-argument")
@@ -0,0 +1,119 @@
+;;; Test grouping of connected objects in the netlister.
+
+(use-modules (srfi srfi-1)
+             (lepton library)
+             (lepton object)
+             (lepton page)
+             (lepton toplevel)
+             (netlist schematic-connection))
+
+(define group-connections
+  (@@ (netlist schematic-connection) group-connections))
+
+(define component-pins
+  (@@ (netlist schematic-connection) component-pins))
+
+
+;;; Former implementation of group-connections() used as
+;;; reference.  Each object is processed in turn, and all existing
+;;; groups it is connected to are merged with it into a new group
+;;; appended to the end of the group list.
+(define (reference-group-connections ls)
+  (define (connected-to? object1 object2)
+    (not (not (memv object1 (object-connections object2)))))
+
+  (define (connected-to-ls? object1 ls)
+    (any (lambda (object2) (connected-to? object1 object2)) ls))
+
+  (define (reconnect-groups object groups)
+    (let-values (((connected unconnected)
+                  (partition (lambda (group) (connected-to-ls? object group))
+                             groups)))
+      `(,@unconnected
+        ,(apply append (list object) connected))))
+
+  (fold reconnect-groups '() ls))
+
+
+(define (page-connectable-objects page)
+  (let ((objects (page-contents page)))
+    (append (filter net? objects)
+            (append-map component-pins (filter component? objects)))))
+
+
+(test-begin "group-connections")
+
+(let ((P (make-page "/test/page/A"))
+      (C (make-component "test component" '(0 . 0) 0 #t #f))
+      (p1 (make-net-pin '(100 . 0) '(0 . 0)))
+      (p2 (make-net-pin '(300 . 0) '(400 . 0)))
+      (p3 (make-net-pin '(100 . 500) '(0 . 500)))
+      (n1 (make-net '(100 . 0) '(200 . 0)))
+      (n2 (make-net '(300 . 0) '(200 . 0)))
+      (n3 (make-net '(200 . 0) '(200 . 100)))
+      (n4 (make-net '(500 . 500) '(600 . 500))))
+
+  (test-group-with-cleanup "group-connections-page"
+    (component-append! C p1 p2 p3)
+    (page-append! P C n1 n2 n3 n4)
+
+    (let ((ls (page-connectable-objects P)))
+      (test-equal (reference-group-connections ls)
+        (group-connections ls))
+      (test-equal (reference-group-connections (reverse ls))
+        (group-connections (reverse ls))))
+
+    (test-equal (list (list n3 n2 n1 p1 p2))
+      (group-connections (list p1 n1 p2 n2 n3)))
+
+    (test-equal (list (list p3) (list n4))
+      (group-connections (list p3 n4)))
+
+    (close-page! P)))
+
+(test-end "group-connections")
+
+
+;;; Compare the result with the former implementation on the
+;;; example designs.
+(test-begin "group-connections-examples")
+
+(define srcdir (getenv "srcdir"))
+(define top-srcdir (string-append srcdir "/../../"))
+(define examples-dir (string-append top-srcdir "tools/netlist/examples/"))
+
+;;; The schematics must be distributed, so every one added here
+;;; must also be listed in EXTRA_DIST of the Makefile.am in its
+;;; directory or in one of its parent directories under
+;;; tools/netlist/examples/.
+(define example-schematics
+  '("7447.sch"
+    "stack_1.sch"
+    "test_verilog.sch"
+    "analog/bandpass/sch/frg_band_pass.sch"
+    "analog/varactor_osc/sch/frg-vco.sch"
+    "analog/voltage_doubler/sch/doubler_a.sch"
+    "analog/voltage_doubler/sch/doubler_b.sch"
+    "analog/voltage_doubler/sch/doubler_c.sch"
+    "spice-noqsi/BBamp/Schematic/BBamp.sch"
+    "spice-noqsi/BBamp/Schematic/Board.sch"
+    "switcap/ckt.sch"))
+
+(reset-component-library)
+(component-library-search (string-append top-srcdir "symbols/sym"))
+
+(with-toplevel
+ (make-toplevel)
+ (lambda ()
+   (for-each
+    (lambda (name)
+      (let* ((filename (string-append examples-dir name))
+             (page (file->page filename))
+             (ls (page-connectable-objects page)))
+        (test-equal filename
+          (reference-group-connections ls)
+          (group-connections ls))
+        (close-page! page)))
+    example-schematics)))
+
+(test-end "group-connections-examples")
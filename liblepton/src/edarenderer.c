@@ -20,6 +20,7 @@
 #include <config.h>
 
 #include <math.h>
+#include <string.h>
 #include <glib.h>
 #include <glib-object.h>
 #include <gdk/gdk.h>
@@ -45,6 +46,8 @@ enum {
   PROP_OVERRIDE_COLOR,
   PROP_GRIP_SIZE,
   PROP_RENDER_FLAGS,
+  PROP_LOD_SIZE,
+  PROP_LOD_SYMBOL_SIZE,
 
   FLAG_HINTING = EDA_RENDERER_FLAG_HINTING,
   FLAG_PICTURE_OUTLINE = EDA_RENDERER_FLAG_PICTURE_OUTLINE,
@@ -69,10 +72,54 @@ struct _EdaRendererPrivate
   int override_color;
   double grip_size;
 
+  /* Level of detail thresholds in device units. */
+  double lod_size;
+  double lod_symbol_size;
+
   GArray *color_map;
 
   /* Cache of font metrics for different font sizes. */
   GHashTable *metrics_cache;
+
+  /* Cache of recorded symbol contents. */
+  GHashTable *display_lists;
+
+  /* Cache of prepared text layouts and its LRU queue, the most
+   * recently used layouts being at the head. */
+  GHashTable *text_layouts;
+  GQueue *text_layout_lru;
+  /* Hinting of text the Pango context is set up for, or -1. */
+  int text_hinting;
+};
+
+/* Text layout ready to be drawn.  Layouts depend only on the
+ * visible string and font size, so they are shared by all text
+ * objects having the same values of them.  They also depend on
+ * the hinting the Pango context is set up for, so all of them are
+ * dropped when it changes. */
+typedef struct _EdaTextLayout EdaTextLayout;
+struct _EdaTextLayout
+{
+  gchar *string;
+  int size;
+
+  PangoLayout *layout;
+  PangoRectangle logical_rect;
+  int descent;
+
+  GList *lru_link;
+};
+
+/* Recorded contents of a symbol, shared by all its instances
+ * having the same contents and drawn with the same renderer
+ * settings. */
+typedef struct _EdaDisplayList EdaDisplayList;
+struct _EdaDisplayList
+{
+  guint64 signature;
+  int uses;
+  cairo_surface_t *surface;
+  double x, y, width, height;
 };
 
 static inline gboolean
@@ -116,6 +163,17 @@ EDA_RENDERER_STROKE_WIDTH0 (EdaRenderer *r, double width) {
 #define TEXT_MARKER_SIZE 10
 #define TEXT_MARKER_COLOR LOCK_COLOR
 
+/* Symbol contents are recorded when they are drawn the second
+ * time, so that symbols drawn only once are never recorded. */
+#define DISPLAY_LIST_MIN_USES 2
+/* Maximum number of recorded symbols. */
+#define DISPLAY_LIST_CACHE_SIZE 1024
+/* With hinting, symbol origins are snapped to this fraction of a
+ * device pixel. */
+#define DISPLAY_LIST_SUBPIXELS 8
+/* Maximum number of prepared text layouts. */
+#define TEXT_LAYOUT_CACHE_SIZE 2048
+
 static GObject *eda_renderer_constructor (GType type,
                                           guint n_construct_properties,
                                           GObjectConstructParam *construct_params);
@@ -143,11 +201,18 @@ static void eda_renderer_draw_arc (EdaRenderer *renderer, LeptonObject *object);
 static void eda_renderer_draw_circle (EdaRenderer *renderer, LeptonObject *object);
 static void eda_renderer_draw_path (EdaRenderer *renderer, LeptonObject *object);
 static void eda_renderer_draw_text (EdaRenderer *renderer, LeptonObject *object);
-static int eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object);
-static void eda_renderer_calc_text_position (EdaRenderer *renderer, const LeptonObject *object,
+static PangoLayout *eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object);
+static void eda_renderer_clear_text_layouts (EdaRenderer *renderer);
+static void eda_renderer_calc_text_position (EdaTextLayout *text_layout, const LeptonObject *object,
                                              double *x, double *y);
 static void eda_renderer_draw_picture (EdaRenderer *renderer, LeptonObject *object);
 static void eda_renderer_draw_component (EdaRenderer *renderer, LeptonObject *object);
+static gboolean eda_renderer_replay_display_list (EdaRenderer *renderer,
+                                                  LeptonObject *object);
+static void eda_display_list_free (EdaDisplayList *list);
+static guint eda_text_layout_hash (gconstpointer key);
+static gboolean eda_text_layout_equal (gconstpointer a, gconstpointer b);
+static void eda_text_layout_free (EdaTextLayout *text_layout);
 
 static void eda_renderer_default_draw_grips (EdaRenderer *renderer, LeptonObject *object);
 static void eda_renderer_draw_grips_list (EdaRenderer *renderer, GList *objects) G_GNUC_UNUSED;
@@ -258,6 +323,18 @@ eda_renderer_class_init (EdaRendererClass *klass)
                                                        EDA_TYPE_RENDERER_FLAGS,
                                                        FLAG_HINTING | FLAG_TEXT_ORIGIN,
                                                        param_flags));
+  g_object_class_install_property (gobject_class, PROP_LOD_SIZE,
+                                   g_param_spec_double ("lod-size",
+                                                        _("Level of detail size"),
+                                                        _("Size in device units below which text is drawn as boxes and hatch fills are not drawn, or 0 to always draw them"),
+                                                        0, G_MAXDOUBLE, 0,
+                                                        param_flags));
+  g_object_class_install_property (gobject_class, PROP_LOD_SYMBOL_SIZE,
+                                   g_param_spec_double ("lod-symbol-size",
+                                                        _("Symbol level of detail size"),
+                                                        _("Size in device units below which symbols are drawn as their bounds, or 0 to always draw their contents"),
+                                                        0, G_MAXDOUBLE, 0,
+                                                        param_flags));
 }
 
 static void
@@ -275,6 +352,20 @@ eda_renderer_init (EdaRenderer *renderer)
   renderer->priv->metrics_cache =
     g_hash_table_new_full (g_int_hash, g_int_equal, g_free,
                            (GDestroyNotify) pango_font_metrics_unref);
+
+  /* Symbols are usually placed many times, so their contents are
+   * recorded once and replayed for every instance. */
+  renderer->priv->display_lists =
+    g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL,
+                           (GDestroyNotify) eda_display_list_free);
+
+  /* Laying out text is expensive too, and most strings are drawn
+   * many times. */
+  renderer->priv->text_layouts =
+    g_hash_table_new_full (eda_text_layout_hash, eda_text_layout_equal, NULL,
+                           (GDestroyNotify) eda_text_layout_free);
+  renderer->priv->text_layout_lru = g_queue_new ();
+  renderer->priv->text_hinting = -1;
 }
 
 static GObject *
@@ -296,6 +387,8 @@ eda_renderer_dispose (GObject *object)
 {
   EdaRenderer *renderer = (EdaRenderer *) object;
 
+  eda_renderer_clear_text_layouts (renderer);
+
   if (renderer->priv->pc != NULL) {
     g_object_unref (renderer->priv->pc);
     renderer->priv->pc = NULL;
@@ -323,6 +416,14 @@ eda_renderer_finalize (GObject *object)
   g_hash_table_destroy (renderer->priv->metrics_cache);
   renderer->priv->metrics_cache = NULL;
 
+  g_hash_table_destroy (renderer->priv->display_lists);
+  renderer->priv->display_lists = NULL;
+
+  g_hash_table_destroy (renderer->priv->text_layouts);
+  renderer->priv->text_layouts = NULL;
+  g_queue_free (renderer->priv->text_layout_lru);
+  renderer->priv->text_layout_lru = NULL;
+
   cairo_destroy (renderer->priv->cr);
   renderer->priv->cr = NULL;
 
@@ -356,6 +457,8 @@ eda_renderer_set_property (GObject *object, guint property_id,
     renderer->priv->font_name = g_value_dup_string (value);
     /* Clear font metrics cache */
     g_hash_table_remove_all (renderer->priv->metrics_cache);
+    g_hash_table_remove_all (renderer->priv->display_lists);
+    eda_renderer_clear_text_layouts (renderer);
     break;
   case PROP_COLOR_MAP:
     renderer->priv->color_map = (GArray*) g_value_get_pointer (value);
@@ -369,6 +472,12 @@ eda_renderer_set_property (GObject *object, guint property_id,
   case PROP_RENDER_FLAGS:
     renderer->priv->flags = g_value_get_flags (value);
     break;
+  case PROP_LOD_SIZE:
+    renderer->priv->lod_size = g_value_get_double (value);
+    break;
+  case PROP_LOD_SYMBOL_SIZE:
+    renderer->priv->lod_symbol_size = g_value_get_double (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -402,6 +511,12 @@ eda_renderer_get_property (GObject *object, guint property_id,
   case PROP_RENDER_FLAGS:
     g_value_set_flags (value, renderer->priv->flags);
     break;
+  case PROP_LOD_SIZE:
+    g_value_set_double (value, renderer->priv->lod_size);
+    break;
+  case PROP_LOD_SYMBOL_SIZE:
+    g_value_set_double (value, renderer->priv->lod_symbol_size);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -421,22 +536,25 @@ eda_renderer_update_contexts (EdaRenderer *renderer, cairo_t *new_cr,
     }
 
     /* If the PangoContext was created from the previous Cairo
-     * context, it needs destroying too. */
-    if (renderer->priv->pc_from_cr) {
-      if (renderer->priv->pc != NULL) {
-        g_object_unref (renderer->priv->pc);
-        renderer->priv->pc = NULL;
-      }
-      if (renderer->priv->pl != NULL) {
-        g_object_unref (renderer->priv->pl);
-        renderer->priv->pl = NULL;
-      }
+     * context, it is just updated for the new one, so that
+     * prepared text layouts can be reused.  Text is always laid
+     * out in user space, so the transformation of the new context
+     * is ignored. */
+    if (renderer->priv->pc_from_cr && renderer->priv->pc != NULL) {
+      cairo_save (new_cr);
+      cairo_identity_matrix (new_cr);
+      pango_cairo_update_context (new_cr, renderer->priv->pc);
+      cairo_restore (new_cr);
     }
 
     renderer->priv->cr = cairo_reference (new_cr);
   }
 
   if (new_pc != NULL) {
+    eda_renderer_clear_text_layouts (renderer);
+    g_hash_table_remove_all (renderer->priv->metrics_cache);
+    renderer->priv->text_hinting = -1;
+
     if (renderer->priv->pc != NULL) {
       g_object_unref (G_OBJECT (renderer->priv->pc));
       renderer->priv->pc = NULL;
@@ -561,6 +679,27 @@ eda_renderer_is_drawable (EdaRenderer *renderer, LeptonObject *object)
   return eda_renderer_is_drawable_color (renderer, color, TRUE);
 }
 
+/* Returns the size in device units of the distance SIZE in user
+ * coordinates. */
+static double
+eda_renderer_device_size (EdaRenderer *renderer, double size)
+{
+  double dx = size, dy = 0;
+
+  cairo_user_to_device_distance (renderer->priv->cr, &dx, &dy);
+  return hypot (dx, dy);
+}
+
+/* Returns TRUE if the distance SIZE in user coordinates is too
+ * small to be drawn in full detail with the level of detail
+ * threshold THRESHOLD. */
+static gboolean
+eda_renderer_below_lod (EdaRenderer *renderer, double size, double threshold)
+{
+  return (threshold > 0
+          && eda_renderer_device_size (renderer, size) < threshold);
+}
+
 static int
 eda_renderer_draw_hatch (EdaRenderer *renderer, LeptonObject *object)
 {
@@ -601,6 +740,18 @@ eda_renderer_draw_hatch (EdaRenderer *renderer, LeptonObject *object)
     g_return_val_if_reached (FALSE);
   }
 
+  /* Dense hatch lines would just blur into the fill, so such
+   * shapes are only outlined. */
+  if (eda_renderer_below_lod (renderer,
+                              lepton_object_get_fill_pitch1 (object),
+                              renderer->priv->lod_size)
+      || (lepton_object_get_fill_type (object) == FILLING_MESH
+          && eda_renderer_below_lod (renderer,
+                                     lepton_object_get_fill_pitch2 (object),
+                                     renderer->priv->lod_size))) {
+    return FALSE;
+  }
+
   /* Handle mesh and hatch fill types */
   fill_lines = g_array_new (FALSE, FALSE, sizeof (LeptonLine));
   if (lepton_fill_type_draw_first_hatch (lepton_object_get_fill_type (object)))
@@ -647,10 +798,335 @@ static void
 eda_renderer_draw_component (EdaRenderer *renderer, LeptonObject *object)
 {
   GList *primitives = lepton_component_object_get_contents (object);
+  LeptonBounds *bounds = &object->bounds;
+
+  /* Draw small symbols as their bounds. */
+  if (renderer->priv->lod_symbol_size > 0
+      && !lepton_bounds_empty (bounds)
+      && eda_renderer_below_lod (renderer,
+                                 MAX (bounds->max_x - bounds->min_x,
+                                      bounds->max_y - bounds->min_y),
+                                 renderer->priv->lod_symbol_size)) {
+    eda_renderer_set_color (renderer, GRAPHIC_COLOR);
+    eda_cairo_box (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
+                   0, bounds->min_x, bounds->max_y,
+                   bounds->max_x, bounds->min_y);
+    eda_cairo_stroke (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
+                      TYPE_SOLID, END_SQUARE,
+                      EDA_RENDERER_STROKE_WIDTH (renderer, 0),
+                      -1, -1);
+    return;
+  }
+
+  if (eda_renderer_replay_display_list (renderer, object))
+    return;
+
   /* Recurse */
   eda_renderer_draw_list (renderer, primitives);
 }
 
+/* ================================================================
+ * SYMBOL DISPLAY LISTS
+ * ================================================================ */
+
+static void
+eda_display_list_free (EdaDisplayList *list)
+{
+  if (list->surface != NULL) {
+    cairo_surface_destroy (list->surface);
+  }
+  g_free (list);
+}
+
+/* Feeds SIZE bytes of DATA into the 64-bit FNV-1a hash HASH. */
+static void
+display_list_hash (guint64 *hash, const void *data, gsize size)
+{
+  const guchar *p = (const guchar *) data;
+  gsize i;
+
+  for (i = 0; i < size; i++) {
+    *hash ^= p[i];
+    *hash *= G_GUINT64_CONSTANT (1099511628211);
+  }
+}
+
+static inline void
+display_list_hash_int (guint64 *hash, int value)
+{
+  display_list_hash (hash, &value, sizeof (value));
+}
+
+static inline void
+display_list_hash_double (guint64 *hash, double value)
+{
+  display_list_hash (hash, &value, sizeof (value));
+}
+
+static inline void
+display_list_hash_string (guint64 *hash, const char *str)
+{
+  /* Include the terminating zero to separate adjacent strings. */
+  if (str != NULL) {
+    display_list_hash (hash, str, strlen (str) + 1);
+  } else {
+    display_list_hash_int (hash, 0);
+  }
+}
+
+/* Hashes everything that affects drawing of OBJECTS relative to
+ * the point (X, Y).  Returns FALSE if some of the objects cannot
+ * be recorded. */
+static gboolean
+eda_renderer_hash_primitives (GList *objects, int x, int y, guint64 *hash)
+{
+  GList *iter;
+  int i;
+
+  for (iter = objects; iter != NULL; iter = g_list_next (iter)) {
+    LeptonObject *object = (LeptonObject *) iter->data;
+    int type = lepton_object_get_type (object);
+
+    display_list_hash_int (hash, type);
+    display_list_hash_int (hash, lepton_object_get_drawing_color (object));
+
+    if (object->stroke != NULL) {
+      display_list_hash_int (hash, object->stroke->type);
+      display_list_hash_int (hash, object->stroke->cap_type);
+      display_list_hash_int (hash, object->stroke->width);
+      display_list_hash_int (hash, object->stroke->dash_length);
+      display_list_hash_int (hash, object->stroke->space_length);
+    }
+    if (object->fill != NULL) {
+      display_list_hash_int (hash, object->fill->type);
+      display_list_hash_int (hash, object->fill->width);
+      display_list_hash_int (hash, object->fill->pitch1);
+      display_list_hash_int (hash, object->fill->angle1);
+      display_list_hash_int (hash, object->fill->pitch2);
+      display_list_hash_int (hash, object->fill->angle2);
+    }
+
+    switch (type) {
+    case OBJ_PIN:
+      display_list_hash_int (hash, object->pin_type);
+      /* Fall through */
+    case OBJ_LINE:
+    case OBJ_NET:
+    case OBJ_BUS:
+      for (i = 0; i < 2; i++) {
+        display_list_hash_int (hash, object->line->x[i] - x);
+        display_list_hash_int (hash, object->line->y[i] - y);
+      }
+      break;
+    case OBJ_BOX:
+      display_list_hash_int (hash, object->box->upper_x - x);
+      display_list_hash_int (hash, object->box->upper_y - y);
+      display_list_hash_int (hash, object->box->lower_x - x);
+      display_list_hash_int (hash, object->box->lower_y - y);
+      break;
+    case OBJ_CIRCLE:
+      display_list_hash_int (hash, object->circle->center_x - x);
+      display_list_hash_int (hash, object->circle->center_y - y);
+      display_list_hash_int (hash, object->circle->radius);
+      break;
+    case OBJ_ARC:
+      display_list_hash_int (hash, object->arc->x - x);
+      display_list_hash_int (hash, object->arc->y - y);
+      display_list_hash_int (hash, object->arc->radius);
+      display_list_hash_int (hash, object->arc->start_angle);
+      display_list_hash_int (hash, object->arc->sweep_angle);
+      break;
+    case OBJ_PATH:
+      for (i = 0; i < object->path->num_sections; i++) {
+        LeptonPathSection *section = &object->path->sections[i];
+        display_list_hash_int (hash, section->code);
+        display_list_hash_int (hash, section->x1 - x);
+        display_list_hash_int (hash, section->y1 - y);
+        display_list_hash_int (hash, section->x2 - x);
+        display_list_hash_int (hash, section->y2 - y);
+        display_list_hash_int (hash, section->x3 - x);
+        display_list_hash_int (hash, section->y3 - y);
+      }
+      break;
+    case OBJ_TEXT:
+      display_list_hash_int (hash, lepton_text_object_get_x (object) - x);
+      display_list_hash_int (hash, lepton_text_object_get_y (object) - y);
+      display_list_hash_int (hash, lepton_text_object_get_size (object));
+      display_list_hash_int (hash, lepton_text_object_get_alignment (object));
+      display_list_hash_int (hash, lepton_text_object_get_angle (object));
+      display_list_hash_int (hash, lepton_text_object_is_visible (object));
+      display_list_hash_string (hash, lepton_text_object_visible_string (object));
+      /* Bounds are used for text outlines. */
+      display_list_hash_int (hash, object->bounds.min_x - x);
+      display_list_hash_int (hash, object->bounds.min_y - y);
+      display_list_hash_int (hash, object->bounds.max_x - x);
+      display_list_hash_int (hash, object->bounds.max_y - y);
+      break;
+    case OBJ_COMPONENT:
+      if (!eda_renderer_hash_primitives (lepton_component_object_get_contents (object),
+                                         x, y, hash))
+        return FALSE;
+      break;
+    default:
+      /* Pictures are not recorded. */
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/* Returns TRUE if drawing to the target of CR is rasterised, so
+ * that replaying recorded symbols does not change the output. */
+static gboolean
+eda_renderer_is_raster_target (cairo_t *cr)
+{
+  switch (cairo_surface_get_type (cairo_get_group_target (cr))) {
+  case CAIRO_SURFACE_TYPE_IMAGE:
+  case CAIRO_SURFACE_TYPE_XLIB:
+  case CAIRO_SURFACE_TYPE_XCB:
+  case CAIRO_SURFACE_TYPE_QUARTZ:
+  case CAIRO_SURFACE_TYPE_WIN32:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+/* Records the contents of the component OBJECT into LIST using
+ * MATRIX as the user to device transformation. */
+static void
+eda_renderer_record_display_list (EdaRenderer *renderer,
+                                  LeptonObject *object,
+                                  EdaDisplayList *list,
+                                  const cairo_matrix_t *matrix)
+{
+  cairo_t *cr = renderer->priv->cr;
+  EdaPangoRenderer *pr = renderer->priv->pr;
+  cairo_font_options_t *options;
+  cairo_t *record_cr;
+
+  list->surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+                                                  NULL);
+  record_cr = cairo_create (list->surface);
+  cairo_set_matrix (record_cr, matrix);
+
+  /* Render text the same way as on the target surface. */
+  options = cairo_font_options_create ();
+  cairo_surface_get_font_options (cairo_get_group_target (cr), options);
+  cairo_set_font_options (record_cr, options);
+  cairo_font_options_destroy (options);
+
+  /* The Pango context and layout do not depend on the Cairo
+   * context, so only the context and the Pango renderer are
+   * swapped. */
+  renderer->priv->cr = record_cr;
+  renderer->priv->pr = (EdaPangoRenderer *) eda_pango_renderer_new (record_cr);
+
+  eda_renderer_draw_list (renderer,
+                          lepton_component_object_get_contents (object));
+
+  g_object_unref (renderer->priv->pr);
+  renderer->priv->pr = pr;
+  renderer->priv->cr = cr;
+  cairo_destroy (record_cr);
+
+  cairo_recording_surface_ink_extents (list->surface,
+                                       &list->x, &list->y,
+                                       &list->width, &list->height);
+}
+
+/* Draws the contents of the component OBJECT from its display
+ * list.  Symbol contents are recorded in device space relative to
+ * the symbol origin, so they are shared by all instances having
+ * the same contents, including rotation and mirroring, at the
+ * same zoom level.  Returns FALSE if the contents have to be
+ * drawn directly. */
+static gboolean
+eda_renderer_replay_display_list (EdaRenderer *renderer,
+                                  LeptonObject *object)
+{
+  cairo_t *cr = renderer->priv->cr;
+  EdaDisplayList *list;
+  GArray *map = renderer->priv->color_map;
+  cairo_matrix_t matrix;
+  guint64 signature = G_GUINT64_CONSTANT (14695981039346656037);
+  double device_x, device_y, x, y, frac_x = 0, frac_y = 0;
+
+  if (!eda_renderer_is_raster_target (cr)) return FALSE;
+
+  device_x = lepton_component_object_get_x (object);
+  device_y = lepton_component_object_get_y (object);
+  cairo_user_to_device (cr, &device_x, &device_y);
+  x = device_x;
+  y = device_y;
+
+  /* Hinting snaps lines to device pixels, so recorded contents
+   * can only be moved by whole pixels.  Symbol origins are
+   * snapped to a fraction of pixel to keep the number of
+   * recordings for different positions small. */
+  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_HINTING)) {
+    frac_x = round ((x - floor (x)) * DISPLAY_LIST_SUBPIXELS) / DISPLAY_LIST_SUBPIXELS;
+    frac_y = round ((y - floor (y)) * DISPLAY_LIST_SUBPIXELS) / DISPLAY_LIST_SUBPIXELS;
+    x = floor (x);
+    y = floor (y);
+  }
+
+  /* The symbol origin is placed at (FRAC_X, FRAC_Y) in the
+   * recording, which is then drawn at (X, Y). */
+  cairo_get_matrix (cr, &matrix);
+  matrix.x0 += frac_x - device_x;
+  matrix.y0 += frac_y - device_y;
+
+  if (!eda_renderer_hash_primitives (lepton_component_object_get_contents (object),
+                                     lepton_component_object_get_x (object),
+                                     lepton_component_object_get_y (object),
+                                     &signature)) {
+    return FALSE;
+  }
+
+  display_list_hash_double (&signature, matrix.xx);
+  display_list_hash_double (&signature, matrix.yx);
+  display_list_hash_double (&signature, matrix.xy);
+  display_list_hash_double (&signature, matrix.yy);
+  display_list_hash_double (&signature, frac_x);
+  display_list_hash_double (&signature, frac_y);
+  display_list_hash_int (&signature, renderer->priv->flags);
+  display_list_hash_int (&signature, renderer->priv->override_color);
+  display_list_hash_double (&signature, renderer->priv->lod_size);
+  display_list_hash_double (&signature, renderer->priv->lod_symbol_size);
+  display_list_hash (&signature, map->data, map->len * sizeof (LeptonColor));
+
+  list = (EdaDisplayList *) g_hash_table_lookup (renderer->priv->display_lists,
+                                                 &signature);
+  if (list == NULL) {
+    if (g_hash_table_size (renderer->priv->display_lists)
+        >= DISPLAY_LIST_CACHE_SIZE) {
+      g_hash_table_remove_all (renderer->priv->display_lists);
+    }
+    list = g_new0 (EdaDisplayList, 1);
+    list->signature = signature;
+    g_hash_table_insert (renderer->priv->display_lists,
+                         &list->signature, list);
+  }
+
+  if (list->surface == NULL) {
+    if (++list->uses < DISPLAY_LIST_MIN_USES) return FALSE;
+    eda_renderer_record_display_list (renderer, object, list, &matrix);
+  }
+
+  if (list->width <= 0 || list->height <= 0) return TRUE;
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+  cairo_set_source_surface (cr, list->surface, x, y);
+  cairo_rectangle (cr, x + list->x, y + list->y, list->width, list->height);
+  cairo_fill (cr);
+  cairo_restore (cr);
+
+  return TRUE;
+}
+
 static void
 eda_renderer_draw_line (EdaRenderer *renderer, LeptonObject *object)
 {
@@ -808,6 +1284,8 @@ eda_renderer_draw_text (EdaRenderer *renderer, LeptonObject *object)
 {
   double x, y;
   double dummy = 0, small_dist = TEXT_MARKER_SIZE;
+  gboolean lod;
+  PangoLayout *layout;
 
   g_return_if_fail (lepton_object_is_text (object));
   g_return_if_fail (object->text != NULL);
@@ -822,8 +1300,20 @@ eda_renderer_draw_text (EdaRenderer *renderer, LeptonObject *object)
   if (lepton_text_object_visible_string (object) == NULL)
     return;
 
-  /* If text outline mode is selected, draw an outline */
-  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_TEXT_OUTLINE)) {
+  /* Text smaller than a pixel is not drawn at all. */
+  lod = FALSE;
+  if (renderer->priv->lod_size > 0 && !lepton_bounds_empty (&object->bounds)) {
+    int text_size = MIN (object->bounds.max_x - object->bounds.min_x,
+                         object->bounds.max_y - object->bounds.min_y);
+    if (eda_renderer_below_lod (renderer, text_size, 1))
+      return;
+    lod = eda_renderer_below_lod (renderer, text_size,
+                                  renderer->priv->lod_size);
+  }
+
+  /* If text outline mode is selected, or the text is too small to
+   * be legible, draw an outline */
+  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_TEXT_OUTLINE) || lod) {
     eda_cairo_box (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
                    0, object->bounds.min_x, object->bounds.max_y,
                    object->bounds.max_x, object->bounds.min_y);
@@ -836,9 +1326,9 @@ eda_renderer_draw_text (EdaRenderer *renderer, LeptonObject *object)
 
   /* Otherwise, actually draw the text */
   cairo_save (renderer->priv->cr);
-  if (eda_renderer_prepare_text (renderer, object)) {
-    eda_pango_renderer_show_layout (renderer->priv->pr, renderer->priv->pl,
-                                    0, 0);
+  layout = eda_renderer_prepare_text (renderer, object);
+  if (layout != NULL) {
+    eda_pango_renderer_show_layout (renderer->priv->pr, layout, 0, 0);
     cairo_restore (renderer->priv->cr);
   } else {
     cairo_restore (renderer->priv->cr);
@@ -885,24 +1375,65 @@ eda_renderer_draw_text (EdaRenderer *renderer, LeptonObject *object)
                     -1, -1);
 }
 
-static int
-eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object)
+/* ================================================================
+ * TEXT LAYOUTS
+ * ================================================================ */
+
+static guint
+eda_text_layout_hash (gconstpointer key)
+{
+  const EdaTextLayout *text_layout = (const EdaTextLayout *) key;
+
+  return (g_str_hash (text_layout->string)
+          ^ (text_layout->size * 31));
+}
+
+static gboolean
+eda_text_layout_equal (gconstpointer a, gconstpointer b)
+{
+  const EdaTextLayout *layout_a = (const EdaTextLayout *) a;
+  const EdaTextLayout *layout_b = (const EdaTextLayout *) b;
+
+  return (layout_a->size == layout_b->size
+          && strcmp (layout_a->string, layout_b->string) == 0);
+}
+
+static void
+eda_text_layout_free (EdaTextLayout *text_layout)
+{
+  if (text_layout->layout != NULL) {
+    g_object_unref (text_layout->layout);
+  }
+  g_free (text_layout->string);
+  g_free (text_layout);
+}
+
+/* Drops all prepared text layouts.  They have to be dropped when
+ * the font or the Pango context they were created with changes. */
+static void
+eda_renderer_clear_text_layouts (EdaRenderer *renderer)
+{
+  g_queue_clear (renderer->priv->text_layout_lru);
+  g_hash_table_remove_all (renderer->priv->text_layouts);
+}
+
+/* Sets up the Pango context for text hinting HINTING unless it is
+ * already set up for it.  All the layouts and font metrics
+ * prepared with the previous hinting share the Pango context, so
+ * they are dropped. */
+static void
+eda_renderer_set_text_hinting (EdaRenderer *renderer, int hinting)
 {
-  gint angle;
-  double points_size, dx, dy;
-  int size;
-  char *draw_string;
   cairo_font_options_t *options;
-  PangoFontDescription *desc;
-  PangoAttrList *attrs;
 
-  points_size = lepton_text_object_get_size_in_points (object);
-  size = lrint (points_size * PANGO_SCALE);
+  if (renderer->priv->text_hinting == hinting) return;
+
+  eda_renderer_clear_text_layouts (renderer);
+  g_hash_table_remove_all (renderer->priv->metrics_cache);
 
-  /* Set hinting as appropriate */
   options = cairo_font_options_create ();
   cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
-  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_HINTING)) {
+  if (hinting) {
     cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_MEDIUM);
   } else {
     cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
@@ -912,28 +1443,125 @@ eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object)
 
   pango_cairo_context_set_resolution (renderer->priv->pc, 1000);
 
-  /* Set font name and size, and obtain descent metric */
-  desc = pango_font_description_from_string (renderer->priv->font_name);
-  pango_font_description_set_size (desc, size);
-  pango_layout_set_font_description (renderer->priv->pl, desc);
-  pango_font_description_free (desc);
+  renderer->priv->text_hinting = hinting;
+}
+
+/* Returns the descent of the renderer font of SIZE in Pango
+ * units. */
+static int
+eda_renderer_get_font_descent (EdaRenderer *renderer,
+                               const PangoFontDescription *desc,
+                               int size)
+{
+  PangoFontMetrics *metrics;
+
+  metrics = (PangoFontMetrics *) g_hash_table_lookup (renderer->priv->metrics_cache,
+                                                      &size);
+  if (metrics == NULL) {
+    metrics = pango_context_get_metrics (renderer->priv->pc, desc, NULL);
+    g_hash_table_insert (renderer->priv->metrics_cache,
+                         g_memdup2 (&size, sizeof (size)),
+                         metrics);
+  }
+
+  return pango_font_metrics_get_descent (metrics);
+}
+
+/* Returns the prepared layout of the text OBJECT, laying it out if
+ * there is no such layout in the cache yet, or NULL if the text
+ * cannot be laid out.  The layout is owned by the cache. */
+static EdaTextLayout *
+eda_renderer_get_text_layout (EdaRenderer *renderer, const LeptonObject *object)
+{
+  EdaTextLayout key, *text_layout;
+  GQueue *lru = renderer->priv->text_layout_lru;
+  char *draw_string;
+  PangoFontDescription *desc;
+  PangoAttrList *attrs;
+  PangoLayout *layout;
+  int hinting = EDA_RENDERER_CHECK_FLAG (renderer, FLAG_HINTING) ? 1 : 0;
+
+  key.string = (gchar *) lepton_text_object_visible_string (object);
+  key.size = lrint (lepton_text_object_get_size_in_points (object)
+                    * PANGO_SCALE);
 
-  /* Extract text to display and Pango text attributes, and then set
-   * up layout. */
-  if (!eda_pango_parse_overbars (lepton_text_object_visible_string (object),
-                                 -1,
-                                 &attrs,
-                                 &draw_string))
+  if (key.string == NULL) return NULL;
+
+  /* Set hinting as appropriate.  This drops the cached layouts if
+   * the hinting has changed. */
+  eda_renderer_set_text_hinting (renderer, hinting);
+
+  text_layout =
+    (EdaTextLayout *) g_hash_table_lookup (renderer->priv->text_layouts, &key);
+  if (text_layout != NULL) {
+    g_queue_unlink (lru, text_layout->lru_link);
+    g_queue_push_head_link (lru, text_layout->lru_link);
+    return text_layout;
+  }
+
+  /* Extract text to display and Pango text attributes. */
+  if (!eda_pango_parse_overbars (key.string, -1, &attrs, &draw_string))
   {
-    return FALSE;
+    return NULL;
   }
-  pango_layout_set_text (renderer->priv->pl, draw_string, -1);
-  pango_layout_set_attributes (renderer->priv->pl, attrs);
+
+  /* Set font name and size, and then set up layout. */
+  layout = pango_layout_new (renderer->priv->pc);
+  desc = pango_font_description_from_string (renderer->priv->font_name);
+  pango_font_description_set_size (desc, key.size);
+  pango_layout_set_font_description (layout, desc);
+  pango_layout_set_text (layout, draw_string, -1);
+  pango_layout_set_attributes (layout, attrs);
   g_free (draw_string);
   pango_attr_list_unref (attrs);
 
+  text_layout = g_new0 (EdaTextLayout, 1);
+  text_layout->string = g_strdup (key.string);
+  text_layout->size = key.size;
+  text_layout->layout = layout;
+
+  /* Text is laid out in user space. */
+  cairo_save (renderer->priv->cr);
+  cairo_identity_matrix (renderer->priv->cr);
+  pango_cairo_update_layout (renderer->priv->cr, layout);
+  pango_layout_get_extents (layout, NULL, &text_layout->logical_rect);
+  cairo_restore (renderer->priv->cr);
+
+  text_layout->descent =
+    eda_renderer_get_font_descent (renderer, desc, key.size);
+  pango_font_description_free (desc);
+
+  /* Drop the least recently used layouts. */
+  while (g_hash_table_size (renderer->priv->text_layouts)
+         >= TEXT_LAYOUT_CACHE_SIZE) {
+    EdaTextLayout *old = (EdaTextLayout *) g_queue_pop_tail (lru);
+    g_hash_table_remove (renderer->priv->text_layouts, old);
+  }
+
+  g_queue_push_head (lru, text_layout);
+  text_layout->lru_link = g_queue_peek_head_link (lru);
+  g_hash_table_add (renderer->priv->text_layouts, text_layout);
+
+  return text_layout;
+}
+
+/* Prepares the text OBJECT for drawing and sets up the
+ * transformation of the Cairo context so that the returned layout
+ * is drawn at the origin.  Returns NULL if the text cannot be
+ * drawn. */
+static PangoLayout *
+eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object)
+{
+  EdaTextLayout *text_layout;
+  gint angle;
+  double dx, dy;
+
+  text_layout = eda_renderer_get_text_layout (renderer, object);
+  if (text_layout == NULL)
+    return NULL;
+
   /* Calculate text position. */
-  eda_renderer_calc_text_position (renderer, object, &dx, &dy);
+  eda_renderer_calc_text_position (text_layout, object, &dx, &dy);
 
   cairo_translate (renderer->priv->cr,
                    lepton_text_object_get_x (object),
@@ -958,48 +1586,33 @@ eda_renderer_prepare_text (EdaRenderer *renderer, const LeptonObject *object)
     cairo_translate (renderer->priv->cr, dx, dy);
   }
 
-  return TRUE;
+  return text_layout->layout;
 }
 
 /* Calculate position to draw text relative to text origin marker, in
  * world coordinates. */
 static void
-eda_renderer_calc_text_position (EdaRenderer *renderer, const LeptonObject *object,
+eda_renderer_calc_text_position (EdaTextLayout *text_layout, const LeptonObject *object,
                                  double *x, double *y)
 {
-  PangoRectangle inked_rect, logical_rect;
-  PangoContext *pcontext;
+  const PangoRectangle *logical_rect = &text_layout->logical_rect;
   double temp;
   double y_lower, y_middle, y_upper;
   double x_left, x_middle, x_right;
-  const PangoFontDescription *fdesc;
-  PangoFontMetrics *fmetrics;
-  gint descent;
-
-  cairo_save (renderer->priv->cr);
-  cairo_identity_matrix (renderer->priv->cr);
-  pango_cairo_update_layout (renderer->priv->cr, renderer->priv->pl);
-  pango_layout_get_extents (renderer->priv->pl,
-                            &inked_rect, &logical_rect);
-
-  pcontext = pango_layout_get_context (renderer->priv->pl);
-  fdesc = pango_layout_get_font_description (renderer->priv->pl);
-  fmetrics = pango_context_get_metrics (pcontext, fdesc, NULL);
-  descent = pango_font_metrics_get_descent (fmetrics);
 
   x_left = 0;
-  x_middle = -logical_rect.width / 2.0;
-  x_right = -logical_rect.width;
+  x_middle = -logical_rect->width / 2.0;
+  x_right = -logical_rect->width;
 
-  y_upper  = -logical_rect.y;                     /* Top of inked extents */
-  y_middle = y_upper - logical_rect.height / 2.;  /* Middle of inked extents */
-  y_lower  = y_upper - logical_rect.height;       /* Baseline of bottom line */
+  y_upper  = -logical_rect->y;                     /* Top of inked extents */
+  y_middle = y_upper - logical_rect->height / 2.;  /* Middle of inked extents */
+  y_lower  = y_upper - logical_rect->height;       /* Baseline of bottom line */
 
   switch (lepton_text_object_get_alignment (object)) {
     case LOWER_LEFT:
     case LOWER_MIDDLE:
     case LOWER_RIGHT:
-      y_lower += descent; break;
+      y_lower += text_layout->descent; break;
     default: break;
   }
 
@@ -1028,7 +1641,6 @@ eda_renderer_calc_text_position (EdaRenderer *renderer, const LeptonObject *obje
 
   *x /= PANGO_SCALE;
   *y /= PANGO_SCALE;
-  cairo_restore (renderer->priv->cr);
 }
 
 static void
@@ -1036,13 +1648,16 @@ eda_renderer_draw_picture (EdaRenderer *renderer, LeptonObject *object)
 {
   int swap_wh;
   double orig_width, orig_height;
+  double dx, dy, scale;
   GdkPixbuf *pixbuf;
+  cairo_surface_t *surface;
   int angle;
+  int width, height;
   int lower_x, lower_y, upper_x, upper_y;
 
   /* Get a pixbuf. If image doesn't exist, libgeda should
    * provide a fallback image. */
-  pixbuf = GDK_PIXBUF (g_object_ref (object->picture->pixbuf));
+  pixbuf = lepton_picture_object_get_pixbuf (object);
 
   lower_x = lepton_picture_object_get_lower_x (object);
   lower_y = lepton_picture_object_get_lower_y (object);
@@ -1058,20 +1673,22 @@ eda_renderer_draw_picture (EdaRenderer *renderer, LeptonObject *object)
                       TYPE_SOLID, END_SQUARE,
                       EDA_RENDERER_STROKE_WIDTH (renderer, 0),
                       -1, -1);
+    if (pixbuf != NULL) g_object_unref (pixbuf);
     return;
   }
 
   g_return_if_fail (GDK_IS_PIXBUF (pixbuf));
 
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+
   cairo_save (renderer->priv->cr);
 
   angle = lepton_picture_object_get_angle (object);
 
   swap_wh = ((angle == 90) || (angle == 270));
-  orig_width  = swap_wh ? gdk_pixbuf_get_height (object->picture->pixbuf)
-                        : gdk_pixbuf_get_width (object->picture->pixbuf);
-  orig_height = swap_wh ? gdk_pixbuf_get_width (object->picture->pixbuf)
-                        : gdk_pixbuf_get_height (object->picture->pixbuf);
+  orig_width  = swap_wh ? height : width;
+  orig_height = swap_wh ? width : height;
 
   cairo_translate (renderer->priv->cr, upper_x, upper_y);
   cairo_scale (renderer->priv->cr,
@@ -1089,17 +1706,36 @@ eda_renderer_draw_picture (EdaRenderer *renderer, LeptonObject *object)
   cairo_rotate (renderer->priv->cr, -angle * M_PI / 180.);
   if (lepton_picture_object_get_mirrored (object))
   {
-    cairo_translate (renderer->priv->cr, gdk_pixbuf_get_width (pixbuf), 0);
+    cairo_translate (renderer->priv->cr, width, 0);
     cairo_scale (renderer->priv->cr, -1, 1);
   }
 
-  gdk_cairo_set_source_pixbuf (renderer->priv->cr,
-                               object->picture->pixbuf, 0,0);
-  cairo_rectangle (renderer->priv->cr, 0, 0,
-                   gdk_pixbuf_get_width (object->picture->pixbuf),
-                   gdk_pixbuf_get_height (object->picture->pixbuf));
-
+  cairo_rectangle (renderer->priv->cr, 0, 0, width, height);
   cairo_clip (renderer->priv->cr);
+
+  /* Find out how many device pixels an image pixel covers along
+   * its shortest side, and pick a matching cached surface. */
+  dx = 1; dy = 0;
+  cairo_user_to_device_distance (renderer->priv->cr, &dx, &dy);
+  scale = hypot (dx, dy);
+  dx = 0; dy = 1;
+  cairo_user_to_device_distance (renderer->priv->cr, &dx, &dy);
+  scale = fmin (scale, hypot (dx, dy));
+
+  surface = lepton_picture_get_surface (object->picture, scale);
+
+  if (surface != NULL) {
+    /* Reduced mipmap levels have to be scaled back up to the
+     * original image size. */
+    cairo_scale (renderer->priv->cr,
+                 (double) width / cairo_image_surface_get_width (surface),
+                 (double) height / cairo_image_surface_get_height (surface));
+    cairo_set_source_surface (renderer->priv->cr, surface, 0, 0);
+    cairo_surface_destroy (surface);
+  } else {
+    gdk_cairo_set_source_pixbuf (renderer->priv->cr, pixbuf, 0, 0);
+  }
+
   cairo_paint (renderer->priv->cr);
 
   cairo_restore (renderer->priv->cr);
@@ -1424,7 +2060,8 @@ eda_renderer_draw_end_cues (EdaRenderer *renderer, LeptonObject *object, int end
   int conn_count = 0;
   int conn_type = CONN_ENDPOINT;
   int is_bus = FALSE;
-  GList *iter;
+  LeptonConnIter iter;
+  LeptonConn conn;
 
   /* We should never be at the unconnectable end of a pin */
   g_return_if_fail (!lepton_object_is_pin (object) ||
@@ -1435,16 +2072,16 @@ eda_renderer_draw_end_cues (EdaRenderer *renderer, LeptonObject *object, int end
             || (lepton_object_is_pin (object)
                 && (object->pin_type == PIN_TYPE_BUS)));
 
-  for (iter = object->conn_list; iter != NULL; iter = g_list_next (iter)) {
-    LeptonConn *conn = (LeptonConn *) iter->data;
-    if ((conn->x != x) || (conn->y != y)) continue;
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
+    if ((conn.x != x) || (conn.y != y)) continue;
 
     /* Check whether the connected object is a bus or bus pin */
-    is_bus |= (lepton_object_is_bus (conn->other_object)
-               || (lepton_object_is_pin (conn->other_object)
-                   && (conn->other_object->pin_type == PIN_TYPE_BUS)));
+    is_bus |= (lepton_object_is_bus (conn.other_object)
+               || (lepton_object_is_pin (conn.other_object)
+                   && (conn.other_object->pin_type == PIN_TYPE_BUS)));
 
-    if (conn->type == CONN_MIDPOINT) {
+    if (conn.type == CONN_MIDPOINT) {
       /* If it's a mid-line connection, we can stop already. */
       conn_type = CONN_MIDPOINT;
       break;
@@ -1489,16 +2126,17 @@ eda_renderer_draw_end_cues (EdaRenderer *renderer, LeptonObject *object, int end
 static void
 eda_renderer_draw_mid_cues (EdaRenderer *renderer, LeptonObject *object)
 {
-  GList *iter;
-  for (iter = object->conn_list; iter != NULL; iter = g_list_next (iter)) {
-    LeptonConn *conn = (LeptonConn *) iter->data;
+  LeptonConnIter iter;
+  LeptonConn conn;
 
-    if (conn->type == CONN_MIDPOINT) {
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
+    if (conn.type == CONN_MIDPOINT) {
       int is_bus = (lepton_object_is_bus (object)
-                    || lepton_object_is_bus (conn->other_object)
-                    || (lepton_object_is_pin (conn->other_object)
-                        && (conn->other_object->pin_type == PIN_TYPE_BUS)));
-      eda_renderer_draw_junction_cue (renderer, conn->x, conn->y, is_bus);
+                    || lepton_object_is_bus (conn.other_object)
+                    || (lepton_object_is_pin (conn.other_object)
+                        && (conn.other_object->pin_type == PIN_TYPE_BUS)));
+      eda_renderer_draw_junction_cue (renderer, conn.x, conn.y, is_bus);
     }
   }
 }
@@ -1570,6 +2208,45 @@ eda_renderer_default_get_user_bounds (EdaRenderer *renderer,
   }
 }
 
+/* Returns the renderer used to calculate text bounds.  It is
+ * created once and kept, so that text layouts prepared for bounds
+ * calculation are reused by subsequent calls. */
+static EdaRenderer *
+eda_renderer_get_bounds_renderer ()
+{
+  static EdaRenderer *renderer = NULL;
+  EdaConfig *cfg;
+  gchar *font_name;
+
+  if (renderer == NULL) {
+    /* Use dummy zero-sized surface */
+    cairo_surface_t *surface =
+      cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
+    cairo_t *cr = cairo_create (surface);
+
+    renderer = eda_renderer_new (cr, NULL);
+
+    cairo_destroy (cr);
+    cairo_surface_destroy (surface);
+  }
+
+  /* Changing the font drops prepared layouts, so only set it if
+   * it differs from the current one. */
+  cfg = eda_config_get_context_for_path (".");
+  font_name = eda_config_get_string (cfg, "schematic.gui", "font", NULL);
+  if (font_name == NULL) {
+    font_name = g_strdup (DEFAULT_FONT_NAME);
+  }
+  if (g_strcmp0 (font_name, renderer->priv->font_name) != 0) {
+    g_object_set (G_OBJECT (renderer),
+                  "font-name", font_name,
+                  NULL);
+  }
+  g_free (font_name);
+
+  return renderer;
+}
+
 gboolean
 eda_renderer_get_text_user_bounds (const LeptonObject *object,
                                    gboolean enable_hidden,
@@ -1593,33 +2270,18 @@ eda_renderer_get_text_user_bounds (const LeptonObject *object,
   if (lepton_text_object_visible_string (object) == NULL)
     return FALSE;
 
-  /* Use dummy zero-sized surface */
-  cairo_surface_t *surface =
-    cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
-  cairo_t *cr = cairo_create (surface);
-
-  EdaRenderer *renderer = eda_renderer_new (NULL, NULL);
-  g_object_set (G_OBJECT (renderer),
-                "cairo-context", cr,
-                NULL);
-  EdaConfig *cfg = eda_config_get_context_for_path (".");
-  gchar *font_name = eda_config_get_string (cfg, "schematic.gui", "font", NULL);
-  if (font_name != NULL) {
-    g_object_set (G_OBJECT (renderer),
-                  "font-name", font_name,
-                  NULL);
-  }
-  g_free (font_name);
+  EdaRenderer *renderer = eda_renderer_get_bounds_renderer ();
+  PangoLayout *layout;
 
   cairo_save (renderer->priv->cr);
 
   /* Set up the text and check it worked. */
-  if (eda_renderer_prepare_text (renderer, object)) {
+  layout = eda_renderer_prepare_text (renderer, object);
+  if (layout != NULL) {
 
     /* Figure out the bounds, send them back.  Note that Pango thinks in
      * device coordinates, but we need world coordinates. */
-    pango_layout_get_pixel_extents (renderer->priv->pl,
-                                    &inked_rect, &logical_rect);
+    pango_layout_get_pixel_extents (layout, &inked_rect, &logical_rect);
     *left = (double) logical_rect.x;
     *top = (double) logical_rect.y;
     *right = (double) logical_rect.x + logical_rect.width;
@@ -1633,12 +2295,10 @@ eda_renderer_get_text_user_bounds (const LeptonObject *object,
     cairo_device_to_user (renderer->priv->cr, right, bottom);
 
     result = TRUE;
+  } else {
+    cairo_restore (renderer->priv->cr);
   }
 
-  cairo_destroy (cr);
-  cairo_surface_destroy (surface);
-  eda_renderer_destroy (renderer);
-
   return result;
 }
 
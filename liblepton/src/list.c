@@ -24,6 +24,11 @@
  *
  *  This LeptonList with the GObject properties can use the signaling
  *  mechanisms of GObject now.
+ *
+ *  Besides the GList of items, the list keeps a hash table mapping
+ *  items to their nodes and a pointer to the last node, so adding,
+ *  removing, and looking up items take constant time while the
+ *  order of items is preserved.
  */
 
 #include <config.h>
@@ -35,6 +40,8 @@
 
 enum {
   CHANGED,
+  ITEM_ADDED,
+  ITEM_REMOVED,
   LAST_SIGNAL
 };
 
@@ -53,6 +60,12 @@ G_DEFINE_TYPE (LeptonList, lepton_list, G_TYPE_OBJECT)
 static void
 lepton_list_init (LeptonList *list)
 {
+  list->glist = NULL;
+  list->nodes = g_hash_table_new (g_direct_hash, g_direct_equal);
+  list->tail = NULL;
+  list->duplicates = 0;
+  list->update_level = 0;
+  list->changed = FALSE;
 }
 
 
@@ -68,6 +81,7 @@ static void lepton_list_finalize( GObject *object )
 {
   LeptonList *list = LEPTON_LIST( object );
   g_list_free( list->glist );
+  g_hash_table_destroy (list->nodes);
 
   G_OBJECT_CLASS( lepton_list_parent_class )->finalize( object );
 }
@@ -99,6 +113,35 @@ lepton_list_class_init (LeptonListClass *klass)
                   G_TYPE_NONE,
                   0     /* n_params */
                  );
+
+  /* Unlike "changed", these signals are emitted immediately for
+   * every item even during bulk updates, so that listeners can
+   * maintain their own state incrementally. */
+  lepton_list_signals[ ITEM_ADDED ] =
+    g_signal_new ("item-added",
+                  G_OBJECT_CLASS_TYPE( gobject_class ),
+                  (GSignalFlags) 0     /*signal_flags */,
+                  0     /*class_offset */,
+                  NULL, /* accumulator */
+                  NULL, /* accu_data */
+                  g_cclosure_marshal_VOID__POINTER,
+                  G_TYPE_NONE,
+                  1,    /* n_params */
+                  G_TYPE_POINTER
+                 );
+
+  lepton_list_signals[ ITEM_REMOVED ] =
+    g_signal_new ("item-removed",
+                  G_OBJECT_CLASS_TYPE( gobject_class ),
+                  (GSignalFlags) 0     /*signal_flags */,
+                  0     /*class_offset */,
+                  NULL, /* accumulator */
+                  NULL, /* accu_data */
+                  g_cclosure_marshal_VOID__POINTER,
+                  G_TYPE_NONE,
+                  1,    /* n_params */
+                  G_TYPE_POINTER
+                 );
 }
 
 
@@ -114,6 +157,62 @@ LeptonList *lepton_list_new( void ) {
 }
 
 
+/*! \brief Emit the "changed" signal of the LeptonList
+ *
+ *  \par Function Description
+ *  Emits the "changed" signal, or postpones it until the
+ *  outermost lepton_list_end_update() if an update is in
+ *  progress.
+ *
+ *  \param [in] list Pointer to the LeptonList
+ */
+static void
+lepton_list_changed (LeptonList *list)
+{
+  if (list->update_level > 0) {
+    list->changed = TRUE;
+    return;
+  }
+
+  g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
+}
+
+
+/*! \brief Register the given node in the membership index
+ *
+ *  \param [in] list Pointer to the LeptonList
+ *  \param [in] node Node of list->glist to register.
+ */
+static void
+lepton_list_index_node (LeptonList *list, GList *node)
+{
+  if (g_hash_table_contains (list->nodes, node->data)) {
+    list->duplicates++;
+  } else {
+    g_hash_table_insert (list->nodes, node->data, node);
+  }
+}
+
+
+/*! \brief Rebuild the membership index of the LeptonList
+ *
+ *  \param [in] list Pointer to the LeptonList
+ */
+static void
+lepton_list_reindex (LeptonList *list)
+{
+  GList *node;
+
+  g_hash_table_remove_all (list->nodes);
+  list->duplicates = 0;
+  list->tail = g_list_last (list->glist);
+
+  for (node = list->glist; node != NULL; node = node->next) {
+    lepton_list_index_node (list, node);
+  }
+}
+
+
 /*! \brief Adds the given item to the LeptonList
  *
  *  \par Function Description
@@ -124,8 +223,23 @@ LeptonList *lepton_list_new( void ) {
  */
 void lepton_list_add( LeptonList *list, gpointer item )
 {
-  list->glist = g_list_append(list->glist, item );
-  g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
+  GList *node = g_list_alloc ();
+
+  node->data = item;
+  node->prev = list->tail;
+  node->next = NULL;
+
+  if (list->tail == NULL) {
+    list->glist = node;
+  } else {
+    list->tail->next = node;
+  }
+  list->tail = node;
+
+  lepton_list_index_node (list, node);
+
+  g_signal_emit (list, lepton_list_signals[ ITEM_ADDED ], 0, item);
+  lepton_list_changed (list);
 }
 
 
@@ -140,9 +254,16 @@ void lepton_list_add( LeptonList *list, gpointer item )
  */
 void lepton_list_add_glist( LeptonList *list, GList *items )
 {
-  GList *glist_copy = g_list_copy( items );
-  list->glist = g_list_concat(list->glist, glist_copy );
-  g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
+  GList *iter;
+
+  lepton_list_begin_update (list);
+
+  for (iter = items; iter != NULL; iter = g_list_next (iter)) {
+    lepton_list_add (list, iter->data);
+  }
+  lepton_list_changed (list);
+
+  lepton_list_end_update (list);
 }
 
 
@@ -158,11 +279,27 @@ void lepton_list_add_glist( LeptonList *list, GList *items )
  */
 void lepton_list_remove( LeptonList *list, gpointer item )
 {
-  if (g_list_find(list->glist, item) == NULL)
+  GList *node = (GList*) g_hash_table_lookup (list->nodes, item);
+
+  if (node == NULL)
     return;
 
-  list->glist = g_list_remove(list->glist, item);
-  g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
+  if (node == list->tail) {
+    list->tail = node->prev;
+  }
+  list->glist = g_list_delete_link (list->glist, node);
+
+  /* Index the next occurrence of the item, if any */
+  if (list->duplicates > 0 &&
+      (node = g_list_find (list->glist, item)) != NULL) {
+    list->duplicates--;
+    g_hash_table_insert (list->nodes, item, node);
+  } else {
+    g_hash_table_remove (list->nodes, item);
+  }
+
+  g_signal_emit (list, lepton_list_signals[ ITEM_REMOVED ], 0, item);
+  lepton_list_changed (list);
 }
 
 
@@ -175,9 +312,20 @@ void lepton_list_remove( LeptonList *list, gpointer item )
  */
 void lepton_list_remove_all( LeptonList *list )
 {
-  g_list_free(list->glist);
+  GList *items = list->glist;
+  GList *iter;
+
   list->glist = NULL;
-  g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
+  list->tail = NULL;
+  list->duplicates = 0;
+  g_hash_table_remove_all (list->nodes);
+
+  for (iter = items; iter != NULL; iter = g_list_next (iter)) {
+    g_signal_emit (list, lepton_list_signals[ ITEM_REMOVED ], 0, iter->data);
+  }
+  g_list_free (items);
+
+  lepton_list_changed (list);
 }
 
 
@@ -186,7 +334,7 @@ void lepton_list_remove_all( LeptonList *list )
 void lepton_list_move_item( LeptonList* list, gpointer item, gint newpos )
 {
   GList* gl = list->glist;
-  GList* node = g_list_find (gl, item);
+  GList* node = (GList*) g_hash_table_lookup (list->nodes, item);
 
   if (node != NULL)
   {
@@ -195,6 +343,70 @@ void lepton_list_move_item( LeptonList* list, gpointer item, gint newpos )
     g_list_free (node);
     list->glist = gl;
 
+    lepton_list_reindex (list);
+    lepton_list_changed (list);
+  }
+}
+
+
+/*! \brief Checks if the given item is in the LeptonList
+ *
+ *  \par Function Description
+ *  Checks if the given item is in the LeptonList in constant
+ *  time.
+ *
+ *  \param [in] list Pointer to the LeptonList
+ *  \param [in] item The item to look for.
+ *  \return TRUE if the item is in the list, otherwise FALSE.
+ */
+gboolean
+lepton_list_contains (LeptonList *list,
+                      gpointer item)
+{
+  g_return_val_if_fail (list != NULL, FALSE);
+
+  return g_hash_table_contains (list->nodes, item);
+}
+
+
+/*! \brief Start a bulk update of the LeptonList
+ *
+ *  \par Function Description
+ *  Postpones emission of the "changed" signal until the matching
+ *  call to lepton_list_end_update().  Then the signal is emitted
+ *  once if the list has been changed in between.  Calls may be
+ *  nested.
+ *
+ *  \param [in] list Pointer to the LeptonList
+ */
+void
+lepton_list_begin_update (LeptonList *list)
+{
+  g_return_if_fail (list != NULL);
+
+  list->update_level++;
+}
+
+
+/*! \brief Finish a bulk update of the LeptonList
+ *
+ *  \par Function Description
+ *  Finishes the update started by lepton_list_begin_update().
+ *  If this is the outermost update, and the list has been
+ *  changed, the "changed" signal is emitted.
+ *
+ *  \param [in] list Pointer to the LeptonList
+ */
+void
+lepton_list_end_update (LeptonList *list)
+{
+  g_return_if_fail (list != NULL);
+  g_return_if_fail (list->update_level > 0);
+
+  list->update_level--;
+
+  if (list->update_level == 0 && list->changed) {
+    list->changed = FALSE;
     g_signal_emit( list, lepton_list_signals[ CHANGED ], 0 );
   }
 }
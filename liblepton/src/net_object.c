@@ -584,24 +584,19 @@ static void o_net_consolidate_lowlevel (LeptonObject *object,
  */
 static int o_net_consolidate_nomidpoint (LeptonObject *object, int x, int y)
 {
-  GList *c_current;
-  LeptonConn *conn;
-
-  c_current = object->conn_list;
-  while(c_current != NULL) {
-    conn = (LeptonConn *) c_current->data;
-    if (conn->other_object) {
-      if (lepton_object_get_id (conn->other_object) != lepton_object_get_id (object) &&
-          conn->x == x && conn->y == y &&
-          conn->type == CONN_MIDPOINT) {
+  LeptonConnIter iter;
+  LeptonConn conn;
+
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
+    if (lepton_object_get_id (conn.other_object) != lepton_object_get_id (object) &&
+        conn.x == x && conn.y == y &&
+        conn.type == CONN_MIDPOINT) {
 #if DEBUG
-        printf("Found one! %s\n", conn->other_object->name);
+      printf("Found one! %s\n", conn.other_object->name);
 #endif
-        return(FALSE);
-      }
+      return(FALSE);
     }
-
-    c_current = g_list_next(c_current);
   }
 
   return(TRUE);
@@ -621,8 +616,8 @@ o_net_consolidate_segments (LeptonObject *object)
 {
   int object_orient;
   int other_orient;
-  GList *c_current;
-  LeptonConn *conn;
+  LeptonConnIter iter;
+  LeptonConn conn;
   LeptonObject *other_object;
   LeptonPage *page;
   int changed = 0;
@@ -635,15 +630,14 @@ o_net_consolidate_segments (LeptonObject *object)
 
   object_orient = lepton_net_object_orientation (object);
 
-  c_current = object->conn_list;
-  while(c_current != NULL) {
-    conn = (LeptonConn *) c_current->data;
-    other_object = conn->other_object;
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
+    other_object = conn.other_object;
 
     /* only look at end points which have a valid end on the other side */
-    if (other_object != NULL && conn->type == CONN_ENDPOINT &&
-        conn->other_whichone != -1 && conn->whichone != -1 &&
-        o_net_consolidate_nomidpoint(object, conn->x, conn->y) ) {
+    if (conn.type == CONN_ENDPOINT &&
+        conn.other_whichone != -1 && conn.whichone != -1 &&
+        o_net_consolidate_nomidpoint(object, conn.x, conn.y) ) {
 
       if (lepton_object_is_net (other_object))
       {
@@ -683,8 +677,6 @@ o_net_consolidate_segments (LeptonObject *object)
       }
 
     }
-
-    c_current = g_list_next (c_current);
   }
 
   return(0);
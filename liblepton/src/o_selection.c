@@ -74,7 +74,7 @@ o_selection_remove (LeptonSelection *selection,
     return;
   }
 
-  if (g_list_find( lepton_list_get_glist( selection ), o_selected ) != NULL) {
+  if (lepton_list_contains ((LeptonList *) selection, o_selected)) {
     o_selection_unselect (o_selected);
     lepton_list_remove( (LeptonList *)selection, o_selected );
   }
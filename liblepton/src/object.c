@@ -1409,6 +1409,10 @@ lepton_object_translate (LeptonObject *object,
   if (func != NULL) {
     (*func) (object, dx, dy);
   }
+
+  if (object->page != NULL) {
+    lepton_page_index_object_changed (object->page, object);
+  }
 }
 
 
@@ -1450,6 +1454,10 @@ lepton_object_rotate (int world_centerx,
   if (func != NULL) {
     (*func) (world_centerx, world_centery, angle, object);
   }
+
+  if (object->page != NULL) {
+    lepton_page_index_object_changed (object->page, object);
+  }
 }
 
 
@@ -1489,6 +1497,10 @@ lepton_object_mirror (int world_centerx,
   if (func != NULL) {
     (*func) (world_centerx, world_centery, object);
   }
+
+  if (object->page != NULL) {
+    lepton_page_index_object_changed (object->page, object);
+  }
 }
 
 
@@ -1792,6 +1804,8 @@ lepton_object_emit_change_notify (LeptonObject *object)
     return;
   }
 
+  lepton_page_index_object_changed (object->page, object);
+
   LeptonToplevel *toplevel = object->page->toplevel;
 
   if (toplevel == NULL) {
@@ -1997,7 +2011,9 @@ lepton_object_new (int type,
   new_node->text = NULL;
   new_node->component = NULL;
 
-  new_node->conn_list = NULL;
+  new_node->conn_array = NULL;
+  new_node->net_parent = NULL;
+  new_node->net_next = NULL;
 
   new_node->stroke = lepton_stroke_new ();
   new_node->fill = lepton_fill_new ();
@@ -55,6 +55,388 @@
 
 static gint global_pid = 0;
 
+/* Size of spatial index cells in world units */
+#define PAGE_INDEX_CELL_SIZE 1024
+
+/* Objects spanning more cells are kept in a separate list */
+#define PAGE_INDEX_MAX_CELLS 64
+
+
+/* Spatial index of page objects.
+ *
+ * Every object of the page has an entry which records its position
+ * in the page's object list and the range of index cells it has
+ * been added to.  Objects are added to the cells covered by their
+ * bounds including hidden text.  Added or changed objects are only
+ * marked pending and are (re)indexed lazily on the next query, so
+ * loading pages and netlisting do not pay for the index.
+ *
+ * Changes are only noticed through change notification.  Code
+ * changing the geometry of an object on a page without emitting
+ * notification must call lepton_page_index_object_changed(),
+ * otherwise the object is not found at its new place. */
+struct st_page_index
+{
+  GHashTable *entries;  /* LeptonObject* -> PageIndexEntry* */
+  GHashTable *cells;    /* gint64 cell key -> PageIndexCell* */
+  GHashTable *pending;  /* set of PageIndexEntry* to be indexed */
+  GPtrArray *large;     /* entries spanning too many cells */
+  guint64 next_order;
+  guint stamp;
+};
+
+typedef struct
+{
+  LeptonObject *object;
+  guint64 order;        /* position in the page's object list */
+  gboolean indexed;     /* the entry is in cells or in the large list */
+  gboolean large;
+  int cell_left;        /* range of cells the entry is in */
+  int cell_top;
+  int cell_right;
+  int cell_bottom;
+  guint stamp;          /* query the entry was last found by */
+} PageIndexEntry;
+
+typedef struct
+{
+  gint64 key;
+  GPtrArray *entries;
+} PageIndexCell;
+
+
+static void
+page_index_cell_free (gpointer data)
+{
+  PageIndexCell *cell = (PageIndexCell*) data;
+
+  g_ptr_array_free (cell->entries, TRUE);
+  g_free (cell);
+}
+
+
+static struct st_page_index*
+page_index_new ()
+{
+  struct st_page_index *index = g_new0 (struct st_page_index, 1);
+
+  index->entries = g_hash_table_new_full (g_direct_hash,
+                                          g_direct_equal,
+                                          NULL,
+                                          g_free);
+  index->cells = g_hash_table_new_full (g_int64_hash,
+                                        g_int64_equal,
+                                        NULL,
+                                        page_index_cell_free);
+  index->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+  index->large = g_ptr_array_new ();
+
+  return index;
+}
+
+
+static void
+page_index_free (struct st_page_index *index)
+{
+  g_hash_table_destroy (index->pending);
+  g_hash_table_destroy (index->cells);
+  g_hash_table_destroy (index->entries);
+  g_ptr_array_free (index->large, TRUE);
+  g_free (index);
+}
+
+
+/* Returns the index of the cell containing world coordinate \a v. */
+static int
+page_index_cell_coord (int v)
+{
+  return (v >= 0) ? (v / PAGE_INDEX_CELL_SIZE)
+                  : -((-(gint64) v - 1) / PAGE_INDEX_CELL_SIZE) - 1;
+}
+
+
+static gint64
+page_index_cell_key (int x, int y)
+{
+  return (gint64) (((guint64) (guint32) x << 32) | (guint32) y);
+}
+
+
+static gint64
+page_index_cell_count (int left, int top, int right, int bottom)
+{
+  return ((gint64) right - left + 1) * ((gint64) bottom - top + 1);
+}
+
+
+/* Removes \a entry from the cells it has been added to. */
+static void
+page_index_unlink (struct st_page_index *index,
+                   PageIndexEntry *entry)
+{
+  int x, y;
+
+  if (!entry->indexed) {
+    return;
+  }
+
+  entry->indexed = FALSE;
+
+  if (entry->large) {
+    g_ptr_array_remove_fast (index->large, entry);
+    return;
+  }
+
+  for (x = entry->cell_left; x <= entry->cell_right; x++) {
+    for (y = entry->cell_top; y <= entry->cell_bottom; y++) {
+      gint64 key = page_index_cell_key (x, y);
+      PageIndexCell *cell =
+        (PageIndexCell*) g_hash_table_lookup (index->cells, &key);
+
+      if (cell == NULL) {
+        continue;
+      }
+
+      g_ptr_array_remove_fast (cell->entries, entry);
+
+      if (cell->entries->len == 0) {
+        g_hash_table_remove (index->cells, &key);
+      }
+    }
+  }
+}
+
+
+/* Adds \a entry to the cells covered by its object's bounds. */
+static void
+page_index_link (struct st_page_index *index,
+                 PageIndexEntry *entry)
+{
+  LeptonObject *object = entry->object;
+  LeptonBounds saved_bounds = object->bounds;
+  int left, top, right, bottom;
+  int visible;
+  int x, y;
+
+  /* Don't disturb the bounds cached for the current
+   * show-hidden-text mode. */
+  visible = lepton_object_calculate_visible_bounds (object,
+                                                    TRUE,
+                                                    &left,
+                                                    &top,
+                                                    &right,
+                                                    &bottom);
+  object->bounds = saved_bounds;
+
+  if (!visible) {
+    return;
+  }
+
+  entry->cell_left   = page_index_cell_coord (left);
+  entry->cell_top    = page_index_cell_coord (top);
+  entry->cell_right  = page_index_cell_coord (right);
+  entry->cell_bottom = page_index_cell_coord (bottom);
+  entry->indexed = TRUE;
+  entry->large = (page_index_cell_count (entry->cell_left,
+                                         entry->cell_top,
+                                         entry->cell_right,
+                                         entry->cell_bottom)
+                  > PAGE_INDEX_MAX_CELLS);
+
+  if (entry->large) {
+    g_ptr_array_add (index->large, entry);
+    return;
+  }
+
+  for (x = entry->cell_left; x <= entry->cell_right; x++) {
+    for (y = entry->cell_top; y <= entry->cell_bottom; y++) {
+      gint64 key = page_index_cell_key (x, y);
+      PageIndexCell *cell =
+        (PageIndexCell*) g_hash_table_lookup (index->cells, &key);
+
+      if (cell == NULL) {
+        cell = g_new (PageIndexCell, 1);
+        cell->key = key;
+        cell->entries = g_ptr_array_new ();
+        g_hash_table_insert (index->cells, &cell->key, cell);
+      }
+
+      g_ptr_array_add (cell->entries, entry);
+    }
+  }
+}
+
+
+/* Indexes the objects added or changed since the last query. */
+static void
+page_index_flush (struct st_page_index *index)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  g_hash_table_iter_init (&iter, index->pending);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    PageIndexEntry *entry = (PageIndexEntry*) key;
+
+    page_index_unlink (index, entry);
+    page_index_link (index, entry);
+  }
+
+  g_hash_table_remove_all (index->pending);
+}
+
+
+static void
+page_index_add (struct st_page_index *index,
+                LeptonObject *object)
+{
+  PageIndexEntry *entry = g_new0 (PageIndexEntry, 1);
+
+  entry->object = object;
+  entry->order = index->next_order++;
+
+  g_hash_table_insert (index->entries, object, entry);
+  g_hash_table_add (index->pending, entry);
+}
+
+
+static void
+page_index_remove (struct st_page_index *index,
+                   LeptonObject *object)
+{
+  PageIndexEntry *entry =
+    (PageIndexEntry*) g_hash_table_lookup (index->entries, object);
+
+  if (entry == NULL) {
+    return;
+  }
+
+  page_index_unlink (index, entry);
+  g_hash_table_remove (index->pending, entry);
+  g_hash_table_remove (index->entries, object);
+}
+
+
+/* Adds \a entry to \a found unless it has already been found by
+ * the current query. */
+static void
+page_index_collect (struct st_page_index *index,
+                    PageIndexEntry *entry,
+                    GPtrArray *found)
+{
+  if (entry->stamp != index->stamp) {
+    entry->stamp = index->stamp;
+    g_ptr_array_add (found, entry);
+  }
+}
+
+
+static gint
+page_index_compare_order (gconstpointer a, gconstpointer b)
+{
+  const PageIndexEntry *entry_a = *(PageIndexEntry* const*) a;
+  const PageIndexEntry *entry_b = *(PageIndexEntry* const*) b;
+
+  if (entry_a->order < entry_b->order) {
+    return -1;
+  }
+  return (entry_a->order > entry_b->order) ? 1 : 0;
+}
+
+
+/* Finds the index entries whose cells intersect the given world
+ * regions.  Returns NULL if the regions cover more cells than are
+ * in use, in which case scanning the object list is cheaper.
+ * Otherwise, returns an array of entries sorted in the order of
+ * the page's object list. */
+static GPtrArray*
+page_index_query (struct st_page_index *index,
+                  LeptonBox *rects,
+                  int n_rects)
+{
+  GPtrArray *found;
+  gint64 n_cells = 0;
+  int i, x, y;
+  guint j;
+
+  page_index_flush (index);
+
+  for (i = 0; i < n_rects; i++) {
+    n_cells += page_index_cell_count (page_index_cell_coord (rects[i].lower_x),
+                                      page_index_cell_coord (rects[i].lower_y),
+                                      page_index_cell_coord (rects[i].upper_x),
+                                      page_index_cell_coord (rects[i].upper_y));
+  }
+
+  if (n_cells > g_hash_table_size (index->cells)) {
+    return NULL;
+  }
+
+  found = g_ptr_array_new ();
+  index->stamp++;
+
+  for (i = 0; i < n_rects; i++) {
+    int left   = page_index_cell_coord (rects[i].lower_x);
+    int top    = page_index_cell_coord (rects[i].lower_y);
+    int right  = page_index_cell_coord (rects[i].upper_x);
+    int bottom = page_index_cell_coord (rects[i].upper_y);
+
+    for (x = left; x <= right; x++) {
+      for (y = top; y <= bottom; y++) {
+        gint64 key = page_index_cell_key (x, y);
+        PageIndexCell *cell =
+          (PageIndexCell*) g_hash_table_lookup (index->cells, &key);
+
+        if (cell == NULL) {
+          continue;
+        }
+
+        for (j = 0; j < cell->entries->len; j++) {
+          page_index_collect (index,
+                              (PageIndexEntry*) g_ptr_array_index (cell->entries, j),
+                              found);
+        }
+      }
+    }
+  }
+
+  for (j = 0; j < index->large->len; j++) {
+    page_index_collect (index,
+                        (PageIndexEntry*) g_ptr_array_index (index->large, j),
+                        found);
+  }
+
+  g_ptr_array_sort (found, page_index_compare_order);
+
+  return found;
+}
+
+
+/*! \brief Update spatial index of page objects
+ *  \par Function Description
+ *  Schedules re-indexing of \a object on \a page after the object
+ *  has been modified.  This is called by change notification and
+ *  by functions transforming objects without notification.
+ *
+ *  \param [in] page   The page the object belongs to.
+ *  \param [in] object The object.
+ */
+void
+lepton_page_index_object_changed (LeptonPage *page,
+                                  LeptonObject *object)
+{
+  PageIndexEntry *entry;
+
+  g_return_if_fail (page != NULL);
+
+  entry = (PageIndexEntry*) g_hash_table_lookup (page->_index->entries, object);
+
+  if (entry != NULL) {
+    g_hash_table_add (page->_index->pending, entry);
+  }
+}
+
 /*! \brief Get page's CHANGED flag value.
  *
  *  \param [in] page The page to obtain the flag of.
@@ -237,6 +619,8 @@ object_added (LeptonPage *page,
 #endif
   object->page = page;
 
+  page_index_add (page->_index, object);
+
   /* Update object connection tracking */
   s_conn_update_object (page, object);
 
@@ -261,6 +645,8 @@ pre_object_removed (LeptonPage *page,
 #endif
   object->page = NULL;
 
+  page_index_remove (page->_index, object);
+
   /* Clear page's object_lastplace pointer if set */
   if (page->object_lastplace == object) {
     page->object_lastplace = NULL;
@@ -305,6 +691,7 @@ lepton_page_new (LeptonToplevel *toplevel,
 
   /* Init the object list */
   page->_object_list = NULL;
+  page->_index = page_index_new ();
 
   /* new selection mechanism */
   lepton_page_set_selection_list (page, o_selection_new());
@@ -397,6 +784,7 @@ lepton_page_delete (LeptonToplevel *toplevel,
 
   /* then delete objects of page */
   lepton_page_delete_objects (page);
+  page_index_free (page->_index);
 
   /* Free the objects in the place list. */
   lepton_object_list_delete (page->place_list);
@@ -603,9 +991,19 @@ lepton_page_replace (LeptonPage *page,
     return;
   }
 
+  PageIndexEntry *entry =
+    (PageIndexEntry*) g_hash_table_lookup (page->_index->entries, object1);
+  guint64 order = (entry != NULL) ? entry->order : 0;
+
   pre_object_removed (page, object1);
   iter->data = object2;
   object_added (page, object2);
+
+  /* Keep the list position of the replaced object */
+  entry = (PageIndexEntry*) g_hash_table_lookup (page->_index->entries, object2);
+  if (entry != NULL) {
+    entry->order = order;
+  }
 }
 
 /*! \brief Remove and free all LeptonObjects from the LeptonPage
@@ -643,17 +1041,53 @@ lepton_page_objects (LeptonPage *page)
 }
 
 
+/* Checks if the bounds of \a object intersect any of the given
+ * regions. */
+static gboolean
+object_in_regions (LeptonObject *object,
+                   LeptonBox *rects,
+                   int n_rects,
+                   gboolean include_hidden)
+{
+  int left, top, right, bottom;
+  int i;
+
+  if (!lepton_object_calculate_visible_bounds (object,
+                                               include_hidden,
+                                               &left,
+                                               &top,
+                                               &right,
+                                               &bottom)) {
+    return FALSE;
+  }
+
+  for (i = 0; i < n_rects; i++) {
+    if (right  >= rects[i].lower_x &&
+        left   <= rects[i].upper_x &&
+        top    <= rects[i].upper_y &&
+        bottom >= rects[i].lower_y) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
 /*! \brief Find the objects in a given region
  *
  *  \par Function Description
  *  Finds the objects which are inside, or intersect
- *  the passed box shaped region.
+ *  the passed box shaped region.  Only the objects found in the
+ *  page's spatial index near the region are tested unless the
+ *  region covers most of the page.
  *
  *  \param [in] page      The LeptonPage to find objects on.
  *  \param [in] rects     The LeptonBox regions to check.
  *  \param [in] n_rects   The number of regions.
  *  \param [in] include_hidden Calculate bounds of hidden objects.
- *  \return The GList of LeptonObjects in the region.
+ *  \return The GList of LeptonObjects in the region, in the order
+ *          of the page's object list.
  */
 GList*
 lepton_page_objects_in_regions (LeptonPage *page,
@@ -663,29 +1097,29 @@ lepton_page_objects_in_regions (LeptonPage *page,
 {
   GList *iter;
   GList *list = NULL;
-  int i;
+  GPtrArray *found;
+  guint i;
+
+  found = page_index_query (page->_index, rects, n_rects);
+
+  if (found != NULL) {
+    for (i = 0; i < found->len; i++) {
+      PageIndexEntry *entry = (PageIndexEntry*) g_ptr_array_index (found, i);
+
+      if (object_in_regions (entry->object, rects, n_rects, include_hidden)) {
+        list = g_list_prepend (list, entry->object);
+      }
+    }
+    g_ptr_array_free (found, TRUE);
+
+    return g_list_reverse (list);
+  }
 
   for (iter = page->_object_list; iter != NULL; iter = g_list_next (iter)) {
     LeptonObject *object = (LeptonObject*) iter->data;
-    int left, top, right, bottom;
-    int visible;
-
-    visible = lepton_object_calculate_visible_bounds (object,
-                                                      include_hidden,
-                                                      &left,
-                                                      &top,
-                                                      &right,
-                                                      &bottom);
-    if (visible) {
-      for (i = 0; i < n_rects; i++) {
-        if (right  >= rects[i].lower_x &&
-            left   <= rects[i].upper_x &&
-            top    <= rects[i].upper_y &&
-            bottom >= rects[i].lower_y) {
-          list = g_list_prepend (list, object);
-          break;
-        }
-      }
+
+    if (object_in_regions (object, rects, n_rects, include_hidden)) {
+      list = g_list_prepend (list, object);
     }
   }
 
@@ -693,6 +1127,89 @@ lepton_page_objects_in_regions (LeptonPage *page,
   return list;
 }
 
+
+/*! \brief Find the objects near a given point
+ *
+ *  \par Function Description
+ *  Finds the objects whose bounds, including hidden text and
+ *  expanded by \a slack, may contain the given point.  The caller
+ *  should do precise hit testing on the returned objects.
+ *
+ *  The objects are returned in the order of the page's object
+ *  list, starting from the first object following \a after.  The
+ *  list wraps around, so \a after, if it is near the point, is
+ *  the last one.  This allows cycling through objects lying on
+ *  top of each other.
+ *
+ *  \param [in] page   The LeptonPage to find objects on.
+ *  \param [in] x      The X coordinate of the point.
+ *  \param [in] y      The Y coordinate of the point.
+ *  \param [in] slack  The distance from the point to search at.
+ *  \param [in] after  The object to start after, or NULL.
+ *  \return The GList of LeptonObjects near the point.  It must be
+ *          freed by the caller with g_list_free().
+ */
+GList*
+lepton_page_objects_at_point (LeptonPage *page,
+                              int x,
+                              int y,
+                              int slack,
+                              LeptonObject *after)
+{
+  LeptonBox rect;
+  GPtrArray *found;
+  GList *head = NULL;
+  GList *tail = NULL;
+  PageIndexEntry *after_entry = NULL;
+  guint i;
+
+  g_return_val_if_fail (page != NULL, NULL);
+
+  rect.lower_x = x - slack;
+  rect.lower_y = y - slack;
+  rect.upper_x = x + slack;
+  rect.upper_y = y + slack;
+
+  if (after != NULL) {
+    after_entry =
+      (PageIndexEntry*) g_hash_table_lookup (page->_index->entries, after);
+  }
+
+  found = page_index_query (page->_index, &rect, 1);
+
+  if (found == NULL) {
+    /* The slack covers more cells than are in use: every object
+     * is a candidate. */
+    const GList *iter;
+    gboolean passed = (after_entry == NULL);
+
+    for (iter = page->_object_list; iter != NULL; iter = g_list_next (iter)) {
+      if (passed) {
+        head = g_list_prepend (head, iter->data);
+      } else {
+        tail = g_list_prepend (tail, iter->data);
+      }
+      if (iter->data == after) {
+        passed = TRUE;
+      }
+    }
+  } else {
+    for (i = 0; i < found->len; i++) {
+      PageIndexEntry *entry = (PageIndexEntry*) g_ptr_array_index (found, i);
+
+      if (after_entry == NULL || entry->order > after_entry->order) {
+        head = g_list_prepend (head, entry->object);
+      } else {
+        tail = g_list_prepend (tail, entry->object);
+      }
+    }
+    g_ptr_array_free (found, TRUE);
+  }
+
+  return g_list_concat (g_list_reverse (head), g_list_reverse (tail));
+}
+
+
 /*! \brief Get the file path associated with a page
  * \par Function Description
  * Retrieve the filename associated with \a page.  The returned string
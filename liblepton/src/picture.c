@@ -342,6 +342,9 @@ lepton_picture_free (LeptonPicture *picture)
   if (picture) {
 
     g_free (picture->file_content);
+    g_free (picture->file_content_base64);
+
+    lepton_picture_invalidate_surfaces (picture);
 
     if (picture->pixbuf) {
       g_object_unref (picture->pixbuf);
@@ -382,3 +385,176 @@ lepton_picture_get_fallback_pixbuf ()
   g_assert (GDK_IS_PIXBUF (pixbuf));
   return GDK_PIXBUF (g_object_ref (pixbuf));
 }
+
+
+
+/*! \brief Convert a pixbuf into a premultiplied cairo surface.
+ * \par Function Description
+ * Creates a new #CAIRO_FORMAT_ARGB32 image surface holding the
+ * pixel data of \a pixbuf.  This is the same conversion
+ * gdk_cairo_set_source_pixbuf() performs on every call.
+ *
+ * \param pixbuf The #GdkPixbuf to convert.
+ * \return A new cairo surface, or NULL on failure.
+ */
+static cairo_surface_t*
+surface_from_pixbuf (GdkPixbuf *pixbuf)
+{
+  int width = gdk_pixbuf_get_width (pixbuf);
+  int height = gdk_pixbuf_get_height (pixbuf);
+  int n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+  int src_stride = gdk_pixbuf_get_rowstride (pixbuf);
+  const guchar *src = gdk_pixbuf_get_pixels (pixbuf);
+  cairo_surface_t *surface;
+  guchar *dst;
+  int dst_stride;
+  int i, j;
+
+  if ((n_channels != 3) && (n_channels != 4))
+    return NULL;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy (surface);
+    return NULL;
+  }
+
+  cairo_surface_flush (surface);
+  dst = cairo_image_surface_get_data (surface);
+  dst_stride = cairo_image_surface_get_stride (surface);
+
+  for (j = 0; j < height; j++) {
+    const guchar *p = src + j * src_stride;
+    guint32 *q = (guint32*) (dst + j * dst_stride);
+
+    for (i = 0; i < width; i++, p += n_channels) {
+      guint a = (n_channels == 4) ? p[3] : 0xff;
+      guint r = p[0], g = p[1], b = p[2];
+
+      if (a != 0xff) {
+        /* Premultiply with correct rounding */
+        guint t;
+        t = r * a + 0x80; r = (t + (t >> 8)) >> 8;
+        t = g * a + 0x80; g = (t + (t >> 8)) >> 8;
+        t = b * a + 0x80; b = (t + (t >> 8)) >> 8;
+      }
+      q[i] = (a << 24) | (r << 16) | (g << 8) | b;
+    }
+  }
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
+
+/*! \brief Create a half-size copy of a cairo image surface.
+ *
+ * \param source The image surface to downscale.
+ * \return A new cairo surface, or NULL if \a source is too small
+ *         to be reduced further.
+ */
+static cairo_surface_t*
+surface_downscale (cairo_surface_t *source)
+{
+  int src_width = cairo_image_surface_get_width (source);
+  int src_height = cairo_image_surface_get_height (source);
+  int width = src_width / 2;
+  int height = src_height / 2;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  if ((width < 1) || (height < 1))
+    return NULL;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  cairo_scale (cr,
+               (double) width / src_width,
+               (double) height / src_height);
+  cairo_set_source_surface (cr, source, 0, 0);
+  cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_GOOD);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+
+/*! \brief Get a cached cairo surface for rendering a picture.
+ * \par Function Description
+ * Returns a premultiplied cairo image surface for the pixbuf of
+ * \a picture.  \a scale is the number of device pixels a single
+ * image pixel is going to cover.  When the picture is drawn at a
+ * small scale, a reduced copy from the picture mipmap chain is
+ * returned instead of the full-resolution image, so that the
+ * whole image does not have to be filtered down on every draw.
+ *
+ * Surfaces are created on first use and kept until
+ * lepton_picture_invalidate_surfaces() is called.  The caller
+ * must release the returned surface with cairo_surface_destroy().
+ *
+ * \param picture The picture to get a surface for.
+ * \param scale   Size of an image pixel in device pixels.
+ * \return A cairo surface, or NULL if the picture has no image data.
+ */
+cairo_surface_t*
+lepton_picture_get_surface (LeptonPicture *picture,
+                            double scale)
+{
+  int level = 0;
+  int i;
+
+  g_return_val_if_fail (picture != NULL, NULL);
+
+  if (picture->pixbuf == NULL)
+    return NULL;
+
+  /* Choose the smallest level which still has at least one
+   * image pixel per device pixel. */
+  while ((level < PICTURE_MIPMAP_LEVELS - 1) && (scale * 2 <= 1.0)) {
+    scale *= 2;
+    level++;
+  }
+
+  if (picture->surface[0] == NULL) {
+    picture->surface[0] = surface_from_pixbuf (picture->pixbuf);
+    if (picture->surface[0] == NULL)
+      return NULL;
+  }
+
+  for (i = 1; i <= level; i++) {
+    if (picture->surface[i] == NULL) {
+      picture->surface[i] = surface_downscale (picture->surface[i - 1]);
+      if (picture->surface[i] == NULL) {
+        /* The image is too small, use the last available level. */
+        level = i - 1;
+        break;
+      }
+    }
+  }
+
+  return cairo_surface_reference (picture->surface[level]);
+}
+
+
+/*! \brief Drop the cached cairo surfaces of a picture.
+ * \par Function Description
+ * Must be called whenever the pixbuf of \a picture changes.
+ *
+ * \param picture The picture to invalidate.
+ */
+void
+lepton_picture_invalidate_surfaces (LeptonPicture *picture)
+{
+  int i;
+
+  g_return_if_fail (picture != NULL);
+
+  for (i = 0; i < PICTURE_MIPMAP_LEVELS; i++) {
+    if (picture->surface[i] != NULL) {
+      cairo_surface_destroy (picture->surface[i]);
+      picture->surface[i] = NULL;
+    }
+  }
+}
@@ -183,7 +183,7 @@ lepton_picture_object_read (const char *first_line,
  *
  */
 gchar*
-lepton_picture_object_to_buffer (const LeptonObject *object)
+lepton_picture_object_to_buffer (LeptonObject *object)
 {
   int width, height, x1, y1;
   gchar *encoded_picture=NULL;
@@ -209,13 +209,19 @@ lepton_picture_object_to_buffer (const LeptonObject *object)
   printf("picture: %d %d %d %d\n", x1, y1, width, height);
 #endif
 
-  /* Encode the picture if it's embedded */
+  /* Encode the picture if it's embedded.  The encoded data is
+   * cached in the picture, so the picture data is encoded only
+   * once no matter how many times it is saved. */
   if (lepton_picture_object_get_embedded (object)) {
-    encoded_picture =
-      s_encoding_base64_encode( (char *)object->picture->file_content,
-                                object->picture->file_length,
-                                &encoded_picture_length,
-                                TRUE);
+    encoded_picture = object->picture->file_content_base64;
+    if (encoded_picture == NULL && object->picture->file_content != NULL) {
+      encoded_picture =
+        s_encoding_base64_encode( (char *)object->picture->file_content,
+                                  object->picture->file_length,
+                                  &encoded_picture_length,
+                                  TRUE);
+      object->picture->file_content_base64 = encoded_picture;
+    }
     if (encoded_picture == NULL) {
       g_message (_("ERROR: unable to encode the picture."));
     }
@@ -246,7 +252,6 @@ lepton_picture_object_to_buffer (const LeptonObject *object)
                           FALSE,
                           filename);
   }
-  g_free(encoded_picture);
 
   return(out);
 }
@@ -315,37 +320,110 @@ lepton_picture_object_new (const gchar *file_content,
   lepton_picture_object_set_mirrored (new_node, mirrored);
   lepton_picture_object_set_embedded (new_node, embedded);
 
+  /* Image data is not decoded here.  Programs which never render
+   * pictures would waste time on it.  See
+   * lepton_picture_object_load_pixbuf(). */
   if (file_content != NULL) {
-    GError *error = NULL;
-    if (!lepton_picture_object_set_from_buffer (new_node,
-                                                filename,
-                                                file_content,
-                                                file_length,
-                                                &error))
-    {
-      g_message (_("Failed to load buffer image [%1$s]: %2$s"),
-                 filename, error->message);
-      g_error_free (error);
+    picture->file_content = (gchar*) g_memdup2 (file_content, file_length);
+    picture->file_length = file_length;
+  }
+
+  return new_node;
+}
+
 
-      /* Force the data into the object anyway, so as to prevent data
-       * loss of embedded images. */
-      picture->file_content = (gchar*) g_memdup2 (file_content, file_length);
-      picture->file_length = file_length;
+/*! \brief Create a pixbuf from a buffer of image data.
+ *
+ * \param data   The image data buffer.
+ * \param len    The size of the data buffer.
+ * \param error  Location to return error information.
+ * \return A new #GdkPixbuf or NULL on failure.
+ */
+static GdkPixbuf*
+pixbuf_from_buffer (const gchar *data,
+                    size_t len,
+                    GError **error)
+{
+  GdkPixbuf *pixbuf;
+  GInputStream *stream;
+
+  stream = G_INPUT_STREAM (g_memory_input_stream_new_from_data (data, len, NULL));
+  pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, error);
+  g_object_unref (stream);
+
+  return pixbuf;
+}
+
+
+/*! \brief Decode the image data of a picture object.
+ *  \par Function Description
+ *  Picture objects keep their raw image data undecoded until
+ *  something needs their pixels or dimensions.  This function
+ *  does the decoding the first time it is called for \a object.
+ *
+ *  If loading the picture data is unsuccessful, and the object
+ *  has a filename, an image will attempt to be loaded from the
+ *  file.  If that fails too, a fallback image is used.  The raw
+ *  image data is kept in any case, so as to prevent data loss of
+ *  embedded images.
+ *
+ *  This does not change the object itself from the point of view
+ *  of the user, so no change notification is emitted.
+ *
+ *  \param [in] object  The picture #LeptonObject to load.
+ */
+static void
+lepton_picture_object_load_pixbuf (LeptonObject *object)
+{
+  LeptonPicture *picture = object->picture;
+  GdkPixbuf *pixbuf = NULL;
+  GError *error = NULL;
+
+  if (picture->decoded || picture->pixbuf != NULL)
+    return;
+
+  picture->decoded = TRUE;
+
+  if (picture->file_content != NULL) {
+    pixbuf = pixbuf_from_buffer (picture->file_content,
+                                 picture->file_length,
+                                 &error);
+    if (pixbuf == NULL) {
+      g_message (_("Failed to load buffer image [%1$s]: %2$s"),
+                 picture->filename, error->message);
+      g_clear_error (&error);
     }
   }
-  if (picture->pixbuf == NULL && filename != NULL) {
-    GError *error = NULL;
-    if (!lepton_picture_object_set_from_file (new_node, filename, &error))
-    {
+
+  if (pixbuf == NULL && picture->filename != NULL) {
+    gchar *buf;
+    size_t len;
+
+    if (g_file_get_contents (picture->filename, &buf, &len, &error)) {
+      pixbuf = pixbuf_from_buffer (buf, len, &error);
+    }
+
+    if (pixbuf == NULL) {
       g_message (_("Failed to load image from [%1$s]: %2$s"),
-                 filename, error->message);
-      g_error_free (error);
+                 picture->filename, error->message);
+      g_clear_error (&error);
       /* picture not found; try to open a fall back pixbuf */
       picture->pixbuf = lepton_picture_get_fallback_pixbuf ();
+      return;
     }
+
+    g_free (picture->file_content);
+    picture->file_content = buf;
+    picture->file_length = len;
+    g_free (picture->file_content_base64);
+    picture->file_content_base64 = NULL;
   }
 
-  return new_node;
+  if (pixbuf != NULL) {
+    picture->pixbuf = pixbuf;
+    picture->ratio = ((double) gdk_pixbuf_get_width (pixbuf) /
+                      gdk_pixbuf_get_height (pixbuf));
+  }
 }
 
 /*! \brief Get picture bounding rectangle in WORLD coordinates.
@@ -414,11 +492,14 @@ lepton_picture_object_get_position (const LeptonObject *object,
  * \return Width/height ratio for the picture object.
  */
 double
-lepton_picture_object_get_ratio (const LeptonObject *object)
+lepton_picture_object_get_ratio (LeptonObject *object)
 {
   g_return_val_if_fail (lepton_object_is_picture (object), 0);
   g_return_val_if_fail (object->picture != NULL, 0);
 
+  /* The ratio is only known for sure after the image is loaded. */
+  lepton_picture_object_load_pixbuf (object);
+
   return object->picture->ratio;
 }
 
@@ -759,7 +840,7 @@ lepton_picture_object_copy (LeptonObject *object)
   /* create the object */
   new_node = lepton_object_new (lepton_object_get_type (object), "picture");
 
-  picture = (LeptonPicture*) g_malloc (sizeof (LeptonPicture));
+  picture = lepton_picture_new ();
   new_node->picture = picture;
 
   lepton_object_set_color (new_node, lepton_object_get_color (object));
@@ -779,14 +860,28 @@ lepton_picture_object_copy (LeptonObject *object)
   }
 
   picture->file_length = object->picture->file_length;
+  picture->file_content_base64 = g_strdup (object->picture->file_content_base64);
   picture->filename    = g_strdup (object->picture->filename);
-  lepton_picture_object_set_ratio (new_node, lepton_picture_object_get_ratio (object));
+  /* Copy the field directly so as not to decode the image */
+  picture->ratio       = object->picture->ratio;
   lepton_picture_object_set_angle (new_node, lepton_picture_object_get_angle (object));
   lepton_picture_object_set_mirrored (new_node, lepton_picture_object_get_mirrored (object));
   lepton_picture_object_set_embedded (new_node, lepton_picture_object_get_embedded (object));
 
-  /* Get the picture data */
-  picture->pixbuf = lepton_picture_object_get_pixbuf (object);
+  /* Get the picture data if it has already been loaded */
+  if (object->picture->pixbuf != NULL) {
+    picture->pixbuf = GDK_PIXBUF (g_object_ref (object->picture->pixbuf));
+  }
+
+  /* The copy is decoded only if it has got the decoded image */
+  picture->decoded = object->picture->decoded && (picture->pixbuf != NULL);
+
+  /* The pixbuf is shared, so can be the surfaces made from it */
+  for (int i = 0; i < PICTURE_MIPMAP_LEVELS; i++) {
+    if (object->picture->surface[i] != NULL) {
+      picture->surface[i] = cairo_surface_reference (object->picture->surface[i]);
+    }
+  }
 
   return new_node;
 }
@@ -815,6 +910,9 @@ lepton_picture_object_embed (LeptonObject *object)
 
   filename = lepton_picture_object_get_filename (object);
 
+  /* Make sure the image data has been read in. */
+  lepton_picture_object_load_pixbuf (object);
+
   if (object->picture->file_content == NULL)
   {
     /* Image has no data: signal an error. */
@@ -988,6 +1086,8 @@ lepton_picture_object_get_pixbuf (LeptonObject *object)
   g_return_val_if_fail (lepton_object_is_picture (object), NULL);
   g_return_val_if_fail (object->picture != NULL, NULL);
 
+  lepton_picture_object_load_pixbuf (object);
+
   if (object->picture->pixbuf != NULL) {
     return GDK_PIXBUF (g_object_ref (object->picture->pixbuf));
   } else {
@@ -1016,7 +1116,6 @@ lepton_picture_object_set_from_buffer (LeptonObject *object,
                                        GError **error)
 {
   GdkPixbuf *pixbuf;
-  GInputStream *stream;
   gchar *tmp;
 
   g_return_val_if_fail (lepton_object_is_picture (object), FALSE);
@@ -1025,17 +1124,18 @@ lepton_picture_object_set_from_buffer (LeptonObject *object,
 
   /* Check that we can actually load the data before making any
    * changes to the object. */
-  stream = G_INPUT_STREAM (g_memory_input_stream_new_from_data (data, len, NULL));
-  pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, error);
-  g_object_unref (stream);
+  pixbuf = pixbuf_from_buffer (data, len, error);
   if (pixbuf == NULL) return FALSE;
 
   lepton_object_emit_pre_change_notify (object);
 
+  lepton_picture_invalidate_surfaces (object->picture);
+
   if (object->picture->pixbuf != NULL) {
     g_object_unref (object->picture->pixbuf);
   }
   object->picture->pixbuf = pixbuf;
+  object->picture->decoded = TRUE;
 
   lepton_picture_object_set_ratio (object,
                                    ((double) gdk_pixbuf_get_width(pixbuf) /
@@ -1053,6 +1153,9 @@ lepton_picture_object_set_from_buffer (LeptonObject *object,
   object->picture->file_content = buf;
   object->picture->file_length = len;
 
+  g_free (object->picture->file_content_base64);
+  object->picture->file_content_base64 = NULL;
+
   lepton_object_emit_change_notify (object);
   return TRUE;
 }
@@ -42,164 +42,330 @@
  *
  *  \image html s_conn_overview.png
  *  \image latex s_conn_overview.pdf "Connection overview" width=14cm
+ *
+ *  Each page also tracks which connectible objects form a net
+ *  using a union-find structure.  Making a connection merges the
+ *  nets of the connected objects immediately.  The members of each
+ *  net are also linked in a ring.  Since union-find cannot split
+ *  sets, removing connections of an object detaches the members of
+ *  its net only, and that net is recomputed from the connections of
+ *  its former members on the next query.  Other nets of the page
+ *  are left intact.  The net ID is the ID of the net member having
+ *  the least object ID plus one, so it is stable while that object
+ *  stays in the net.
+ */
+
+
+/*! \brief Get a connection from a connection array.
+ *
+ *  \param array  The connection array.
+ *  \param index  The index of the connection.
+ *  \return The pointer to the connection in the array.
  */
+#define s_conn_array_index(array, index) \
+  (&g_array_index ((array), LeptonConn, (index)))
 
 
-/*! \brief create a new connection object
+/*! \brief check if a connection is uniq in the connections of an object
  *  \par Function Description
- *  create a single st_conn object and initialize it with the
- *  given parameters.
+ *  This function checks if there's no identical connection
+ *  in the connection array of \a object.
  *
- *  \return The new connection object
+ *  \param object        The object to check.
+ *  \param other_object  The "other" object of the connection.
+ *  \param type          The type of the connection.
+ *  \param x             The x coord of the connection position.
+ *  \param y             The y coord of the connection position.
+ *  \return TRUE if the connection is unique, FALSE otherwise.
  */
-LeptonConn*
-s_conn_return_new (LeptonObject *other_object,
-                   int type,
-                   int x,
-                   int y,
-                   int whichone,
-                   int other_whichone)
+static int
+s_conn_uniq (LeptonObject *object,
+             LeptonObject *other_object,
+             int type,
+             int x,
+             int y)
 {
-  LeptonConn *new_conn;
+  LeptonConn *conn;
+  guint i;
 
-  new_conn = (LeptonConn *) g_malloc(sizeof(LeptonConn));
+  if (object->conn_array == NULL) {
+    return (TRUE);
+  }
 
-#if DEBUG
-  printf("** creating: %s %d %d\n", other_object->name, x, y);
-#endif
+  for (i = 0; i < object->conn_array->len; i++) {
+    conn = s_conn_array_index (object->conn_array, i);
 
-  new_conn->other_object = other_object;
-  new_conn->type = type;
-  new_conn->x = x;
-  new_conn->y = y;
-  new_conn->whichone = whichone;
-  new_conn->other_whichone = other_whichone;
+    if (conn->other_object == other_object &&
+        conn->x == x && conn->y == y &&
+        conn->type == type) {
+      return (FALSE);
+    }
+  }
 
-  return (new_conn);
+  return (TRUE);
 }
 
-/*! \brief check if a connection is uniq in a list
+/*! \brief remove a connection from the connection array of an object
  *  \par Function Description
- *  This function checks if there's no identical connection
- *  in the list of connections.
- *  \param conn_list list of connection objects
- *  \param input_conn single connection object.
- *  \return TRUE if the LeptonConn structure is unique, FALSE otherwise.
+ *  This function removes the connection at \a index from the
+ *  connection array of \a object.  The order of the remaining
+ *  connections is preserved, and the back-indices of the reverse
+ *  connections of the shifted ones are updated, so the cost is
+ *  proportional to the number of connections of \a object.
+ *
+ *  The reverse connection stored in the "other" object is not
+ *  touched.
+ *
+ *  \param object  The object to remove the connection from.
+ *  \param index   The index of the connection to remove.
  */
-int
-s_conn_uniq (GList * conn_list,
-             LeptonConn * input_conn)
+static void
+s_conn_array_remove (LeptonObject *object,
+                     guint index)
 {
-  GList *c_current;
+  GArray *array = object->conn_array;
   LeptonConn *conn;
+  guint i;
 
-  c_current = conn_list;
-  while (c_current != NULL) {
-    conn = (LeptonConn *) c_current->data;
+  g_array_remove_index (array, index);
 
-    if (conn->other_object == input_conn->other_object &&
-        conn->x == input_conn->x && conn->y == input_conn->y &&
-        conn->type == input_conn->type) {
-      return (FALSE);
-    }
+  for (i = index; i < array->len; i++) {
+    conn = s_conn_array_index (array, i);
+    s_conn_array_index (conn->other_object->conn_array,
+                        conn->other_index)->other_index = i;
+  }
+}
 
-    c_current = g_list_next(c_current);
+/*! \brief Find the root of the net of an object.
+ *  \par Function Description
+ *  Returns the object representing the net \a object belongs to in
+ *  the union-find structure of its page.  The path to the root is
+ *  shortened on the way.
+ *
+ *  \param object  The connectible LeptonObject.
+ *  \return The root object of the net.
+ */
+static LeptonObject*
+s_conn_net_find (LeptonObject *object)
+{
+  while (object->net_parent != object) {
+    object->net_parent = object->net_parent->net_parent;
+    object = object->net_parent;
   }
 
-  return (TRUE);
+  return object;
 }
 
-/*! \brief remove a object from the connection list of another object
+/*! \brief Detach the members of the net of an object.
  *  \par Function Description
- *  This function removes the LeptonObject <b>to_remove</b> from the connection
- *  list of the LeptonObject <b>other_object</b>.
+ *  Walks the ring of the members of the net \a object belongs to
+ *  and marks each of them as having an unknown net.  Should be
+ *  called whenever connections of \a object are going to be
+ *  removed.  The cost is proportional to the size of the net.
  *
- *  \param other_object LeptonObject from that the to_remove LeptonObject needs to be removed
- *  \param to_remove LeptonObject to remove
- *  \return TRUE if a connection has been deleted, FALSE otherwise
+ *  \param object  The LeptonObject.
  */
-int
-s_conn_remove_other (LeptonObject *other_object,
-                     LeptonObject *to_remove)
+static void
+s_conn_net_invalidate (LeptonObject *object)
 {
-  GList *c_current = NULL;
-  LeptonConn *conn = NULL;
+  LeptonObject *member = object;
+  LeptonObject *next;
 
-  lepton_object_emit_pre_change_notify (other_object);
+  if (object->net_next == NULL) {
+    return;
+  }
 
-  c_current = other_object->conn_list;
-  while (c_current != NULL) {
-    conn = (LeptonConn *) c_current->data;
+  do {
+    next = member->net_next;
+    member->net_parent = NULL;
+    member->net_next = NULL;
+    member = next;
+  } while (member != object);
+}
 
-    if (conn->other_object == to_remove) {
-      other_object->conn_list =
-        g_list_remove(other_object->conn_list, conn);
+/*! \brief Merge the nets of two connected objects.
+ *  \par Function Description
+ *  The root having the least object ID becomes the root of the
+ *  merged net, and the rings of members of both nets are joined.
+ *  If the net of either object is unknown, the other net is
+ *  detached as well, and they are recomputed together later.
+ *
+ *  \param page          The LeptonPage the objects belong to.
+ *  \param object        The first connected LeptonObject.
+ *  \param other_object  The second connected LeptonObject.
+ */
+static void
+s_conn_net_union (LeptonPage *page,
+                  LeptonObject *object,
+                  LeptonObject *other_object)
+{
+  LeptonObject *root;
+  LeptonObject *other_root;
+  LeptonObject *next;
 
-#if DEBUG
-      printf("Found other_object in remove_other\n");
-      printf("Freeing other: %s %d %d\n", conn->other_object->name,
-             conn->x, conn->y);
-#endif
+  if (page == NULL) {
+    return;
+  }
+
+  if (object->net_next == NULL || other_object->net_next == NULL) {
+    s_conn_net_invalidate (object);
+    s_conn_net_invalidate (other_object);
+    return;
+  }
+
+  root = s_conn_net_find (object);
+  other_root = s_conn_net_find (other_object);
+
+  if (root == other_root) {
+    return;
+  }
+
+  next = root->net_next;
+  root->net_next = other_root->net_next;
+  other_root->net_next = next;
+
+  if (lepton_object_get_id (root) < lepton_object_get_id (other_root)) {
+    other_root->net_parent = root;
+  } else {
+    root->net_parent = other_root;
+  }
+}
+
+/*! \brief Recompute the net of an object.
+ *  \par Function Description
+ *  Collects the objects of \a page which are connected to \a
+ *  object, directly or through other objects, and whose net is
+ *  unknown.  They form a new net whose root is the member having
+ *  the least object ID.  Nets of other objects are not touched.
+ *
+ *  \param page    The LeptonPage \a object belongs to.
+ *  \param object  The LeptonObject whose net is unknown.
+ */
+static void
+s_conn_net_resolve (LeptonPage *page,
+                    LeptonObject *object)
+{
+  GPtrArray *stack = g_ptr_array_new ();
+  LeptonObject *root = object;
+  LeptonObject *member;
+  LeptonObject *other;
+  LeptonConn *conn;
+  guint i;
+
+  object->net_next = object;
+  g_ptr_array_add (stack, object);
 
-      /* Do not write modify c_current like this, since this will cause */
-      /* very nasty data corruption and upset glib's memory slice */
-      /* allocator. */
-      /* c_current->data = NULL;   Do not comment in */
+  while (stack->len > 0) {
+    member = (LeptonObject*) g_ptr_array_remove_index_fast (stack,
+                                                            stack->len - 1);
 
-      g_free(conn);
+    for (i = 0; i < s_conn_count (member); i++) {
+      conn = s_conn_array_index (member->conn_array, i);
+      other = conn->other_object;
 
-#if 0 /* this does not work right */
-      if (lepton_object_is_bus (other_object) &&
-          other_object->conn_list == NULL) {
-        other_object->bus_ripper_direction = 0;
+      if (other->net_next != NULL ||
+          lepton_object_get_page (other) != page) {
+        continue;
       }
-#endif
 
-      return (TRUE);
+      other->net_next = object->net_next;
+      object->net_next = other;
+      g_ptr_array_add (stack, other);
+
+      if (lepton_object_get_id (other) < lepton_object_get_id (root)) {
+        root = other;
+      }
     }
+  }
+
+  g_ptr_array_free (stack, TRUE);
+
+  member = object;
+  do {
+    member->net_parent = root;
+    member = member->net_next;
+  } while (member != object);
+}
+
+/*! \brief Get the net ID of an object.
+ *  \par Function Description
+ *  Returns the ID of the net \a object belongs to.  All pins,
+ *  nets, and buses connected to each other, directly or through
+ *  other objects, have the same net ID.  The ID does not change
+ *  until the net is split or merged with another one.
+ *
+ *  \param object  The LeptonObject.
+ *  \return The net ID, or 0 if \a object is not a pin, net, or bus
+ *          included in a page.
+ */
+int
+s_conn_get_net_id (LeptonObject *object)
+{
+  LeptonPage *page;
+
+  g_return_val_if_fail (object != NULL, 0);
+
+  switch (lepton_object_get_type (object)) {
+    case OBJ_PIN:
+    case OBJ_NET:
+    case OBJ_BUS:
+      break;
 
-    c_current = g_list_next(c_current);
+    default:
+      return 0;
   }
 
-  lepton_object_emit_change_notify (other_object);
+  page = lepton_object_get_page (object);
+  if (page == NULL) {
+    return 0;
+  }
+
+  if (object->net_next == NULL) {
+    s_conn_net_resolve (page, object);
+  }
 
-  return (FALSE);
+  return lepton_object_get_id (s_conn_net_find (object)) + 1;
 }
 
 /*! \brief remove an LeptonObject from the connection system
  *  \par Function Description
  *  This function removes all connections from and to the LeptonObject
- *  <b>to_remove</b>.
+ *  <b>to_remove</b>.  Each reverse connection is found in the
+ *  "other" object by its back-index, so no searching is needed.
  *
  *  \param to_remove LeptonObject to unconnected from all other objects
  */
 void
 s_conn_remove_object_connections (LeptonObject *to_remove)
 {
-  GList *c_iter;
   LeptonConn *conn;
+  LeptonObject *other_object;
   GList *iter;
   LeptonObject *o_current;
+  guint i;
 
   switch (lepton_object_get_type (to_remove)) {
     case OBJ_PIN:
     case OBJ_NET:
     case OBJ_BUS:
-      for (c_iter = to_remove->conn_list;
-           c_iter != NULL;
-           c_iter = g_list_next (c_iter)) {
-        conn = (LeptonConn *) c_iter->data;
+      if (to_remove->conn_array == NULL) {
+        break;
+      }
 
-        /* keep calling this till it returns false (all refs removed) */
-        /* there is NO body to this while loop */
-        while (s_conn_remove_other (conn->other_object, to_remove));
+      s_conn_net_invalidate (to_remove);
 
-        c_iter->data = NULL;
-        g_free (conn);
+      for (i = 0; i < to_remove->conn_array->len; i++) {
+        conn = s_conn_array_index (to_remove->conn_array, i);
+        other_object = conn->other_object;
+
+        lepton_object_emit_pre_change_notify (other_object);
+        s_conn_net_invalidate (other_object);
+        s_conn_array_remove (other_object, conn->other_index);
+        lepton_object_emit_change_notify (other_object);
       }
 
-      g_list_free (to_remove->conn_list);
-      to_remove->conn_list = NULL;
+      g_array_free (to_remove->conn_array, TRUE);
+      to_remove->conn_array = NULL;
       break;
 
     case OBJ_COMPONENT:
@@ -320,19 +486,62 @@ static int check_direct_compat (LeptonObject *object1, LeptonObject *object2)
 }
 
 
-static void add_connection (LeptonObject *object, LeptonObject *other_object,
+/*! \brief Connect two objects
+ *
+ *  \par Function Description
+ *  Adds a connection to \a other_object into the connection array
+ *  of \a object, and the reverse connection into the array of \a
+ *  other_object.  Both connections store the index of each other.
+ *  Nothing is done if the connection already exists.  The nets of
+ *  the objects are merged.
+ *
+ *  \param page            The LeptonPage the objects belong to
+ *  \param object          The first LeptonObject
+ *  \param other_object    The second LeptonObject
+ *  \param type            The type of the connection
+ *  \param x               The x coord of the connection position
+ *  \param y               The y coord of the connection position
+ *  \param whichone        The endpoint of \a object
+ *  \param other_whichone  The endpoint of \a other_object
+ */
+static void add_connection (LeptonPage *page,
+                            LeptonObject *object, LeptonObject *other_object,
                             int type, int x, int y,
                             int whichone, int other_whichone)
 {
-  /* Describe the connection */
-  LeptonConn *new_conn =
-    s_conn_return_new (other_object, type, x, y, whichone, other_whichone);
-  /* Do uniqness check */
-  if (s_conn_uniq (object->conn_list, new_conn)) {
-    object->conn_list = g_list_append (object->conn_list, new_conn);
-  } else {
-    g_free (new_conn);
+  LeptonConn conn;
+  guint index;
+
+  /* Connections are always added in pairs, so if the connection
+   * is not unique, its reverse is not unique either. */
+  if (!s_conn_uniq (object, other_object, type, x, y)) {
+    return;
+  }
+
+  if (object->conn_array == NULL) {
+    object->conn_array = g_array_new (FALSE, FALSE, sizeof (LeptonConn));
   }
+  if (other_object->conn_array == NULL) {
+    other_object->conn_array = g_array_new (FALSE, FALSE, sizeof (LeptonConn));
+  }
+
+  conn.other_object = other_object;
+  conn.type = type;
+  conn.x = x;
+  conn.y = y;
+  conn.whichone = whichone;
+  conn.other_whichone = other_whichone;
+  conn.other_index = other_object->conn_array->len;
+  g_array_append_val (object->conn_array, conn);
+  index = object->conn_array->len - 1;
+
+  conn.other_object = object;
+  conn.whichone = other_whichone;
+  conn.other_whichone = whichone;
+  conn.other_index = index;
+  g_array_append_val (other_object->conn_array, conn);
+
+  s_conn_net_union (page, object, other_object);
 }
 
 /*! \brief add a line LeptonObject to the connection system
@@ -417,14 +626,10 @@ s_conn_update_line_object (LeptonPage* page,
 
           lepton_object_emit_pre_change_notify (other_object);
 
-          add_connection (object, other_object, CONN_ENDPOINT,
+          add_connection (page, object, other_object, CONN_ENDPOINT,
                           other_object->line->x[k],
                           other_object->line->y[k], j, k);
 
-          add_connection (other_object, object, CONN_ENDPOINT,
-                          object->line->x[j],
-                          object->line->y[j], k, j);
-
           lepton_object_emit_change_notify (other_object);
         }
       }
@@ -451,13 +656,9 @@ s_conn_update_line_object (LeptonPage* page,
            check_direct_compat (object, other_object)))
       {
 
-        add_connection (object, other_object, CONN_MIDPOINT,
+        add_connection (page, object, other_object, CONN_MIDPOINT,
                         object->line->x[k],
                         object->line->y[k], k, -1);
-
-        add_connection (other_object, object, CONN_MIDPOINT,
-                        object->line->x[k],
-                        object->line->y[k], -1, k);
       }
     }
 
@@ -482,19 +683,15 @@ s_conn_update_line_object (LeptonPage* page,
             lepton_object_is_net (other_object)) ||
            check_direct_compat (object, other_object))) {
 
-        add_connection (object, other_object, CONN_MIDPOINT,
+        add_connection (page, object, other_object, CONN_MIDPOINT,
                         other_object->line->x[k],
                         other_object->line->y[k], -1, k);
-
-        add_connection (other_object, object, CONN_MIDPOINT,
-                        other_object->line->x[k],
-                        other_object->line->y[k], k, -1);
       }
     }
   }
 
 #if DEBUG
-  s_conn_print(object->conn_list);
+  s_conn_print (object);
 #endif
 }
 
@@ -532,95 +729,164 @@ s_conn_update_object (LeptonPage* page,
   }
 }
 
-/*! \brief print all connections of a connection list
+/*! \brief print all connections of an object
  *  \par Function Description
- *  This is a debugging function to print a List of connections.
- *  \param conn_list GList of connection objects
+ *  This is a debugging function to print the connections of an
+ *  object.
+ *  \param object The LeptonObject whose connections to print
  */
-void s_conn_print(GList * conn_list)
+void s_conn_print (LeptonObject *object)
 {
-  LeptonConn *conn;
-  GList *cl_current;
+  LeptonConnIter iter;
+  LeptonConn conn;
 
   printf("\nStarting s_conn_print\n");
-  cl_current = conn_list;
-  while (cl_current != NULL) {
 
-    conn = (LeptonConn *) cl_current->data;
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
     printf("-----------------------------------\n");
-    printf("other object: %s\n", conn->other_object->name);
-    printf("type: %d\n", conn->type);
-    printf("x: %d y: %d\n", conn->x, conn->y);
-    printf("whichone: %d\n", conn->whichone);
-    printf("other_whichone: %d\n", conn->other_whichone);
+    printf("other object: %s\n", conn.other_object->name);
+    printf("type: %d\n", conn.type);
+    printf("x: %d y: %d\n", conn.x, conn.y);
+    printf("whichone: %d\n", conn.whichone);
+    printf("other_whichone: %d\n", conn.other_whichone);
     printf("-----------------------------------\n");
-
-    cl_current = g_list_next(cl_current);
   }
 
 }
 
 /*! \brief Search for net in existing connections.
  *  \par Function Description
- *  This method searches the connection list for the first matching
- *  connection with the given x, y, and whichone endpoint.
+ *  This method searches the connections of the net for the first
+ *  matching connection with the given x, y, and whichone endpoint.
  *
- *  \param [in] new_net    Net LeptonObject to compare to.
+ *  \param [in] new_net    Net LeptonObject to search connections of.
  *  \param [in] whichone   The connection number to check.
- *  \param [in] conn_list  List of existing connections to compare
- *                         <B>new_net</B> to.
  *  \return TRUE if a matching connection is found, FALSE otherwise.
  */
-int s_conn_net_search(LeptonObject* new_net, int whichone, GList * conn_list)
+int s_conn_net_search (LeptonObject* new_net, int whichone)
 {
-  LeptonConn *conn;
-  GList *cl_current;
-
-  cl_current = conn_list;
-  while (cl_current != NULL) {
-
-    conn = (LeptonConn *) cl_current->data;
-    if (conn != NULL && conn->whichone == whichone &&
-        conn->x == new_net->line->x[whichone] &&
-        conn->y == new_net->line->y[whichone])
+  LeptonConnIter iter;
+  LeptonConn conn;
+
+  s_conn_iter_init (&iter, new_net);
+  while (s_conn_iter_next (&iter, &conn)) {
+    if (conn.whichone == whichone &&
+        conn.x == new_net->line->x[whichone] &&
+        conn.y == new_net->line->y[whichone])
     {
        return TRUE;
     }
-
-    cl_current = g_list_next(cl_current);
   }
 
   return FALSE;
 }
 
-/*! \brief get a list of all objects connected to a list of LeptonObjects.
+/*! \brief Start iterating over connections of an object.
  *
  *  \par Function Description
- *  This function gets all other_object from the connection
- *  list of the LeptonObjects in the pased list.
+ *  Initializes \a iter for iterating over the connections of \a
+ *  object with s_conn_iter_next().  If \a object is a component,
+ *  the connections of its primitives are iterated.
+ *
+ *  \param [out] iter    The iterator to initialize.
+ *  \param [in]  object  The LeptonObject to get connections of.
+ */
+void
+s_conn_iter_init (LeptonConnIter *iter,
+                  LeptonObject *object)
+{
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (object != NULL);
+
+  iter->index = 0;
+
+  if (lepton_object_is_component (object))
+  {
+    iter->current = NULL;
+    iter->primitives = lepton_component_object_get_contents (object);
+  }
+  else
+  {
+    iter->current = object;
+    iter->primitives = NULL;
+  }
+}
+
+/*! \brief Get the next connection of an object.
  *
- *  \param [in] input_list GList of LeptonObject's or NULL
- *  \param [in] obj_list   The GList of LeptonObject to get connections from
- *  \return A GList of objects
+ *  \par Function Description
+ *  Copies the next connection to \a conn and advances \a iter.
+ *  Connections added while iterating are reached as well.  The
+ *  connection system must not be otherwise modified while
+ *  iterating.
  *
- *  \warning
- *  Caller must g_list_free returned GList pointer.
- *  Do not free individual data items in list.
+ *  \param [in,out] iter  The iterator initialized with
+ *                        s_conn_iter_init().
+ *  \param [out]    conn  The location to copy the connection to.
+ *  \return TRUE if a connection has been found, FALSE if there
+ *          are no more connections.
  */
-static GList *s_conn_return_glist_others (GList *input_list, GList *obj_list)
+gboolean
+s_conn_iter_next (LeptonConnIter *iter,
+                  LeptonConn *conn)
 {
-  GList *return_list;
-  GList *iter;
-  LeptonObject *o_current;
+  LeptonConn *c_current;
 
-  return_list = input_list;
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (conn != NULL, FALSE);
 
-  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
-    o_current = (LeptonObject*) iter->data;
-    return_list = s_conn_return_others (return_list, o_current);
+  for (;;) {
+    if (iter->current != NULL && iter->current->conn_array != NULL) {
+      while (iter->index < iter->current->conn_array->len) {
+        c_current = s_conn_array_index (iter->current->conn_array,
+                                        iter->index++);
+
+        if (c_current->other_object &&
+            c_current->other_object != iter->current) {
+          *conn = *c_current;
+          return TRUE;
+        }
+      }
+    }
+
+    if (iter->primitives == NULL) {
+      return FALSE;
+    }
+
+    iter->current = (LeptonObject*) iter->primitives->data;
+    iter->primitives = g_list_next (iter->primitives);
+    iter->index = 0;
   }
+}
+
+/*! \brief Get the number of connections of a primitive object.
+ *
+ *  \param [in] object  The LeptonObject.
+ *  \return The number of connections of \a object.
+ */
+guint
+s_conn_count (const LeptonObject *object)
+{
+  g_return_val_if_fail (object != NULL, 0);
 
-  return return_list;
+  return (object->conn_array == NULL) ? 0 : object->conn_array->len;
+}
+
+/*! \brief Get an object connected to a primitive object.
+ *
+ *  \param [in] object  The LeptonObject.
+ *  \param [in] index   The index of the connection, less than
+ *                      s_conn_count().
+ *  \return The "other" object of the connection.
+ */
+LeptonObject*
+s_conn_get_other_object (const LeptonObject *object,
+                         guint index)
+{
+  g_return_val_if_fail (index < s_conn_count (object), NULL);
+
+  return s_conn_array_index (object->conn_array, index)->other_object;
 }
 
 /*! \brief get a list of all objects connected to this one
@@ -640,33 +906,16 @@ static GList *s_conn_return_glist_others (GList *input_list, GList *obj_list)
  */
 GList *s_conn_return_others(GList *input_list, LeptonObject *object)
 {
-  GList *c_iter;
-  GList *return_list;
-  GList *primitives;
+  LeptonConnIter iter;
+  LeptonConn conn;
+  GList *others = NULL;
 
-  return_list = input_list;
-
-  switch (lepton_object_get_type (object)) {
-    case OBJ_PIN:
-    case OBJ_NET:
-    case OBJ_BUS:
-      for (c_iter = object->conn_list;
-           c_iter != NULL; c_iter = g_list_next (c_iter)) {
-        LeptonConn *conn = (LeptonConn *) c_iter->data;
-
-        if (conn->other_object && conn->other_object != object) {
-          return_list = g_list_append(return_list, conn->other_object);
-        }
-      }
-      break;
-
-    case OBJ_COMPONENT:
-      primitives = lepton_component_object_get_contents (object);
-      return_list = s_conn_return_glist_others (return_list, primitives);
-      break;
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
+    others = g_list_prepend (others, conn.other_object);
   }
 
-  return return_list;
+  return g_list_concat (input_list, g_list_reverse (others));
 }
 
 /*! \brief add a line object to the list of connectible objects
@@ -691,6 +940,11 @@ s_conn_add_line_object (LeptonPage *page,
 
   if (!g_list_find (page->connectible_list, object)) {
     page->connectible_list = g_list_append (page->connectible_list, object);
+
+    if (object->net_next == NULL && s_conn_count (object) == 0) {
+      object->net_parent = object;
+      object->net_next = object;
+    }
   }
 }
 
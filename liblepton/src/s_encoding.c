@@ -49,6 +49,10 @@
 #include <string.h>
 #endif
 
+#ifdef HAVE_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
 static gchar s_encoding_Base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 #define s_encoding_Pad64	'='
 static guchar s_encoding_Base64_rank[256] = {
@@ -70,6 +74,300 @@ static guchar s_encoding_Base64_rank[256] = {
 	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xf0-0xff	*/
 };
 
+/* Number of 3 byte groups encoded on a line in strict mode. */
+#define s_encoding_LINE_GROUPS (72/4)
+
+/* Set by s_encoding_set_vectorized() to bypass the vector codecs. */
+static gboolean s_encoding_force_scalar = FALSE;
+
+
+/* ================================================================
+ * Block codecs
+ *
+ * Each block codec converts a run of complete groups, 3 bytes of
+ * binary data to 4 characters of base64 and back.  They know
+ * nothing about line wrapping and padding, which are handled by
+ * the callers.
+ * ================================================================ */
+
+/*! \brief Encode complete groups of binary data.
+ *  \par Function Description
+ *  Portable table-driven encoder.  Converts \a ngroups groups of 3
+ *  bytes from \a src to 4 characters each in \a dst.
+ */
+static void
+s_encoding_encode_groups_scalar (const guchar *src, gchar *dst,
+                                 guint ngroups)
+{
+  while (ngroups-- > 0)
+    {
+      guint32 v = (src[0] << 16) | (src[1] << 8) | src[2];
+
+      dst[0] = s_encoding_Base64[(v >> 18) & 0x3f];
+      dst[1] = s_encoding_Base64[(v >> 12) & 0x3f];
+      dst[2] = s_encoding_Base64[(v >> 6) & 0x3f];
+      dst[3] = s_encoding_Base64[v & 0x3f];
+
+      src += 3;
+      dst += 4;
+    }
+}
+
+/*! \brief Decode complete groups of base64 characters.
+ *  \par Function Description
+ *  Portable table-driven decoder.  Converts as many groups of 4
+ *  characters from \a src as possible, at most \a ngroups, to 3
+ *  bytes each in \a dst.  Stops at the first group containing a
+ *  character which is not in the base64 alphabet, including
+ *  padding and white space.
+ *
+ *  \return The number of groups decoded.
+ */
+static guint
+s_encoding_decode_groups_scalar (const guchar *src, guchar *dst,
+                                 guint ngroups)
+{
+  guint n;
+
+  for (n = 0; n < ngroups; n++)
+    {
+      guint a = s_encoding_Base64_rank[src[0]];
+      guint b = s_encoding_Base64_rank[src[1]];
+      guint c = s_encoding_Base64_rank[src[2]];
+      guint d = s_encoding_Base64_rank[src[3]];
+      guint32 v;
+
+      /* Every valid rank fits in 6 bits, so any invalid
+       * character sets a high bit here. */
+      if ((a | b | c | d) & 0xc0)
+        break;
+
+      v = (a << 18) | (b << 12) | (c << 6) | d;
+      dst[0] = (v >> 16) & 0xff;
+      dst[1] = (v >> 8) & 0xff;
+      dst[2] = v & 0xff;
+
+      src += 4;
+      dst += 3;
+    }
+  return n;
+}
+
+#ifdef HAVE_AVX2_TARGET
+
+/*! \brief Encode 24 bytes at \a src to 32 characters at \a dst.
+ *  \par Function Description
+ *  Reads 28 bytes from \a src, so the caller must make sure they
+ *  are available.
+ */
+__attribute__ ((target ("avx2")))
+static inline void
+s_encoding_encode_block_avx2 (const guchar *src, gchar *dst)
+{
+  /* Each 128-bit lane gets 12 bytes of input. */
+  __m256i in = _mm256_inserti128_si256 (
+    _mm256_castsi128_si256 (_mm_loadu_si128 ((const __m128i *) src)),
+    _mm_loadu_si128 ((const __m128i *) (src + 12)), 1);
+
+  /* Spread 3 bytes to every 32-bit word as [b1 b0 b2 b1] */
+  in = _mm256_shuffle_epi8 (in, _mm256_setr_epi8 (
+    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+    1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+  /* Move each 6-bit value to its own byte */
+  __m256i t0 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x0fc0fc00));
+  __m256i t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+  __m256i t2 = _mm256_and_si256 (in, _mm256_set1_epi32 (0x003f03f0));
+  __m256i t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+  __m256i indices = _mm256_or_si256 (t1, t3);
+
+  /* Translate values to the alphabet by adding an offset chosen
+   * by the value range: A-Z, a-z, 0-9, '+', and '/'. */
+  __m256i offsets = _mm256_setr_epi8 (
+    65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+    65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+  __m256i range = _mm256_subs_epu8 (indices, _mm256_set1_epi8 (51));
+  __m256i lower = _mm256_cmpgt_epi8 (indices, _mm256_set1_epi8 (25));
+  range = _mm256_sub_epi8 (range, lower);
+
+  __m256i out = _mm256_add_epi8 (indices,
+                                 _mm256_shuffle_epi8 (offsets, range));
+  _mm256_storeu_si256 ((__m256i *) dst, out);
+}
+
+/*! \brief AVX2 version of s_encoding_encode_groups_scalar().
+ *
+ *  \param src_end  End of the source buffer, used to avoid reading
+ *                  past it.
+ */
+__attribute__ ((target ("avx2")))
+static void
+s_encoding_encode_groups_avx2 (const guchar *src, gchar *dst,
+                               guint ngroups, const guchar *src_end)
+{
+  while ((ngroups >= 8) && (src_end - src >= 28))
+    {
+      s_encoding_encode_block_avx2 (src, dst);
+      src += 24;
+      dst += 32;
+      ngroups -= 8;
+    }
+  s_encoding_encode_groups_scalar (src, dst, ngroups);
+}
+
+/*! \brief Decode 32 characters at \a src to 24 bytes at \a dst.
+ *  \par Function Description
+ *  Writes 32 bytes to \a dst.
+ *
+ *  \return A bit mask of the characters not in the base64
+ *          alphabet.  Nothing useful is written if it is not 0.
+ */
+__attribute__ ((target ("avx2")))
+static inline guint32
+s_encoding_decode_block_avx2 (const guchar *src, guchar *dst)
+{
+  const __m256i lut_lo = _mm256_setr_epi8 (
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lut_hi = _mm256_setr_epi8 (
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8 (
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_2f = _mm256_set1_epi8 (0x2f);
+
+  __m256i str = _mm256_loadu_si256 ((const __m256i *) src);
+
+  /* Classify the characters by their high and low nibbles.  A
+   * character is valid if its two classes have no common bits. */
+  __m256i hi_nibbles = _mm256_and_si256 (_mm256_srli_epi32 (str, 4), mask_2f);
+  __m256i lo_nibbles = _mm256_and_si256 (str, mask_2f);
+  __m256i hi = _mm256_shuffle_epi8 (lut_hi, hi_nibbles);
+  __m256i lo = _mm256_shuffle_epi8 (lut_lo, lo_nibbles);
+  __m256i bad = _mm256_cmpeq_epi8 (_mm256_and_si256 (lo, hi),
+                                   _mm256_setzero_si256 ());
+  guint32 invalid = ~ (guint32) _mm256_movemask_epi8 (bad);
+
+  if (invalid != 0)
+    return invalid;
+
+  /* Convert characters to their 6-bit values */
+  __m256i eq_2f = _mm256_cmpeq_epi8 (str, mask_2f);
+  __m256i roll = _mm256_shuffle_epi8 (lut_roll,
+                                      _mm256_add_epi8 (eq_2f, hi_nibbles));
+  str = _mm256_add_epi8 (str, roll);
+
+  /* Pack 4 values of 6 bits to 3 bytes in every 32-bit word */
+  __m256i merged = _mm256_maddubs_epi16 (str, _mm256_set1_epi32 (0x01400140));
+  __m256i out = _mm256_madd_epi16 (merged, _mm256_set1_epi32 (0x00011000));
+  out = _mm256_shuffle_epi8 (out, _mm256_setr_epi8 (
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+    2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  out = _mm256_permutevar8x32_epi32 (out,
+                                     _mm256_setr_epi32 (0, 1, 2, 4, 5, 6, 3, 7));
+  _mm256_storeu_si256 ((__m256i *) dst, out);
+
+  return 0;
+}
+
+/*! \brief AVX2 version of s_encoding_decode_groups_scalar().
+ *  \par Function Description
+ *  \a dst must have room for 8 bytes more than the decoded data.
+ */
+__attribute__ ((target ("avx2")))
+static guint
+s_encoding_decode_groups_avx2 (const guchar *src, guchar *dst,
+                               guint ngroups)
+{
+  guint n = 0;
+
+  while (ngroups - n >= 8)
+    {
+      if (s_encoding_decode_block_avx2 (src, dst) != 0)
+        break;
+      src += 32;
+      dst += 24;
+      n += 8;
+    }
+  return n + s_encoding_decode_groups_scalar (src, dst, ngroups - n);
+}
+
+/*! \brief Check whether vector block codecs can be used.
+ *  \par Function Description
+ *  The instruction set is checked once at run time, so the same
+ *  binary works on processors without AVX2.
+ */
+static gboolean
+s_encoding_use_avx2 (void)
+{
+  static gint use_avx2 = -1;
+
+  if (s_encoding_force_scalar)
+    return FALSE;
+
+  if (use_avx2 < 0)
+    use_avx2 = __builtin_cpu_supports ("avx2") ? 1 : 0;
+
+  return use_avx2;
+}
+
+#endif /* HAVE_AVX2_TARGET */
+
+/*! \brief Enable or disable the vectorized codecs.
+ *  \par Function Description
+ *  Allows the test suite to run the scalar codecs on processors
+ *  supporting the vectorized ones.
+ *
+ *  \param [in] enable  FALSE to always use the scalar codecs.
+ *  \return TRUE if the vectorized codecs are going to be used.
+ */
+gboolean
+s_encoding_set_vectorized (gboolean enable)
+{
+  s_encoding_force_scalar = !enable;
+
+#ifdef HAVE_AVX2_TARGET
+  return s_encoding_use_avx2 ();
+#else
+  return FALSE;
+#endif
+}
+
+static void
+s_encoding_encode_groups (const guchar *src, gchar *dst,
+                          guint ngroups, const guchar *src_end)
+{
+#ifdef HAVE_AVX2_TARGET
+  if (s_encoding_use_avx2 ())
+    {
+      s_encoding_encode_groups_avx2 (src, dst, ngroups, src_end);
+      return;
+    }
+#endif
+  s_encoding_encode_groups_scalar (src, dst, ngroups);
+}
+
+static guint
+s_encoding_decode_groups (const guchar *src, guchar *dst,
+                          guint ngroups)
+{
+#ifdef HAVE_AVX2_TARGET
+  if (s_encoding_use_avx2 ())
+    return s_encoding_decode_groups_avx2 (src, dst, ngroups);
+#endif
+  return s_encoding_decode_groups_scalar (src, dst, ngroups);
+}
+
+
+/* ================================================================
+ * Public functions
+ * ================================================================ */
+
 /*! \brief Convert a buffer from binary to base64 representation.
  *  \par Function Description
  *  Convert a buffer from binary to base64 representation.  Set
@@ -86,11 +384,13 @@ static guchar s_encoding_Base64_rank[256] = {
 gchar* s_encoding_base64_encode (gchar* src, guint srclen, 
 				 guint* dstlenp, gboolean strict) 
 {
+  const guchar *in = (const guchar *) src;
+  const guchar *in_end = in + srclen;
   gchar* dst;
   guint dstpos;
+  guint ngroups;
   guchar input[3];
   guchar output[4];
-  guint ocnt;
   guint i;
 
   if (srclen == 0) 
@@ -104,52 +404,35 @@ gchar* s_encoding_base64_encode (gchar* src, guint srclen,
 
   dst = g_new(gchar, *dstlenp );
 
-  /* bulk encoding */
+  /* bulk encoding, a line at a time if strict */
   dstpos = 0;
-  ocnt = 0;
-  while (srclen >= 3) 
+  ngroups = srclen / 3;
+  while (ngroups > 0)
     {
-      /*
-	Convert 3 bytes of src to 4 bytes of output
+      guint n = ngroups;
 
-	output[0] = input[0] 7:2
-	output[1] = input[0] 1:0 input[1] 7:4
-	output[2] = input[1] 3:0 input[2] 7:6
-	output[3] = input[1] 5:0
+      if (strict && (n > s_encoding_LINE_GROUPS))
+        n = s_encoding_LINE_GROUPS;
 
-       */
-      input[0] = *src++;
-      input[1] = *src++;
-      input[2] = *src++;
-      srclen -= 3;
+      g_assert ((dstpos + 4 * n) < *dstlenp);
 
-      output[0] = (input[0] >> 2);
-      output[1] = ((input[0] & 0x03) << 4) + 
-	(input[1] >> 4);
-      output[2] = ((input[1] & 0x0f) << 2) + 
-	(input[2] >> 6);
-      output[3] = (input[2] & 0x3f);
+      s_encoding_encode_groups (in, dst + dstpos, n, in_end);
+      in += 3 * n;
+      dstpos += 4 * n;
+      ngroups -= n;
 
-      g_assert ((dstpos + 4) < *dstlenp);
-
-      /* Map output to the Base64 alphabet */
-      dst[dstpos++] = s_encoding_Base64[(guint) output[0]];
-      dst[dstpos++] = s_encoding_Base64[(guint) output[1]];
-      dst[dstpos++] = s_encoding_Base64[(guint) output[2]];
-      dst[dstpos++] = s_encoding_Base64[(guint) output[3]];
-
-      /* Add a newline if strict and  */
-      if (strict)
-	if ((++ocnt % (72/4)) == 0) 
-	  dst[dstpos++] = '\n';
+      /* Add a newline after each full line if strict */
+      if (strict && (n == s_encoding_LINE_GROUPS))
+        dst[dstpos++] = '\n';
     }
+  srclen -= in - (const guchar *) src;
 
   /* Now worry about padding with remaining 1 or 2 bytes */
   if (srclen != 0) 
     {
       input[0] = input[1] = input[2] = '\0';
       for (i = 0; i < srclen; i++) 
-	input[i] = *src++;
+	input[i] = *in++;
 
       output[0] = (input[0] >> 2);
       output[1] = ((input[0] & 0x03) << 4) + 
@@ -185,6 +468,11 @@ gchar* s_encoding_base64_encode (gchar* src, guint srclen,
  *  function is liberal in what it will accept.  It ignores non-base64
  *  symbols.
  *  
+ *  Runs of complete groups of base64 characters are converted by
+ *  the block decoder.  Everything else, that is, line breaks and
+ *  other characters to skip, groups split by them, and padding,
+ *  goes through the character-by-character state machine below.
+ *
  *  \param [in]  src      Source buffer.
  *  \param [in]  srclen   Length of the source buffer.
  *  \param [out] dstlenp  Pointer to length of the destination buffer
@@ -206,13 +494,29 @@ gchar *s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp)
   dstidx = 0;
   res = 0;
 
-  dst = g_new(gchar, srclen+1);
+  /* The block decoder may write up to 8 bytes past the decoded
+   * data. */
+  dst = g_new(gchar, srclen+9);
   *dstlenp = srclen+1;
 
   while (srclen > 0)
     {
+      /* On a group boundary, try to decode as many complete groups
+       * as possible at once. */
+      if ((state == 0) && (srclen >= 4))
+	{
+	  guint n = s_encoding_decode_groups ((const guchar *) src,
+	                                      (guchar *) dst + dstidx,
+	                                      srclen / 4);
+	  src += 4 * n;
+	  srclen -= 4 * n;
+	  dstidx += 3 * n;
+	  if (srclen == 0)
+	    break;
+	}
+
       srclen--;
-      ch = *src++;
+      ch = (guchar) *src++;
       if (ch == s_encoding_Pad64) 
 	break;
       if (s_encoding_Base64_rank[ch]==255) /* Skip any non-base64 anywhere */
@@ -264,7 +568,7 @@ gchar *s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp)
 	  while (srclen > 0)
 	    {
 	      srclen--;
-	      ch = *src++;
+	      ch = (guchar) *src++;
 	      if (ch == s_encoding_Pad64) break;
 	      if (s_encoding_Base64_rank[ch] != 255) break;
 	    }
@@ -284,7 +588,7 @@ gchar *s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp)
 	  while (srclen > 0)
 	    {
 	      srclen--;
-	      ch = *src++;
+	      ch = (guchar) *src++;
 	      if (s_encoding_Base64_rank[ch] != 255) 
 		{
 		  g_free(dst);
@@ -0,0 +1,186 @@
+#include <glib.h>
+#include <liblepton.h>
+
+static void
+count_changed (LeptonList *list, gpointer user_data)
+{
+  (*(gint*) user_data)++;
+}
+
+static void
+count_item (LeptonList *list, gpointer item, gpointer user_data)
+{
+  (*(gint*) item)++;
+}
+
+void
+check_order ()
+{
+  gint items[4];
+  LeptonList *list = lepton_list_new ();
+  GList *iter;
+  gint index;
+
+  for (index = 0; index < 4; index++) {
+    lepton_list_add (list, &items[index]);
+  }
+
+  iter = lepton_list_get_glist (list);
+  for (index = 0; index < 4; index++) {
+    g_assert_nonnull (iter);
+    g_assert_true (iter->data == &items[index]);
+    iter = g_list_next (iter);
+  }
+  g_assert_null (iter);
+
+  lepton_list_remove (list, &items[1]);
+  lepton_list_add (list, &items[1]);
+
+  iter = lepton_list_get_glist (list);
+  g_assert_true (iter->data == &items[0]);
+  g_assert_true (g_list_last (iter)->data == &items[1]);
+  g_assert_cmpuint (g_list_length (iter), ==, 4);
+
+  g_object_unref (list);
+}
+
+void
+check_contains ()
+{
+  gint items[3];
+  LeptonList *list = lepton_list_new ();
+
+  g_assert_false (lepton_list_contains (list, &items[0]));
+
+  lepton_list_add (list, &items[0]);
+  lepton_list_add (list, &items[1]);
+  g_assert_true (lepton_list_contains (list, &items[0]));
+  g_assert_true (lepton_list_contains (list, &items[1]));
+  g_assert_false (lepton_list_contains (list, &items[2]));
+
+  lepton_list_remove (list, &items[0]);
+  g_assert_false (lepton_list_contains (list, &items[0]));
+  g_assert_true (lepton_list_contains (list, &items[1]));
+
+  /* removing an absent item does nothing */
+  lepton_list_remove (list, &items[2]);
+  g_assert_cmpuint (g_list_length (lepton_list_get_glist (list)), ==, 1);
+
+  lepton_list_remove_all (list);
+  g_assert_false (lepton_list_contains (list, &items[1]));
+  g_assert_null (lepton_list_get_glist (list));
+
+  g_object_unref (list);
+}
+
+void
+check_duplicates ()
+{
+  gint items[2];
+  LeptonList *list = lepton_list_new ();
+
+  lepton_list_add (list, &items[0]);
+  lepton_list_add (list, &items[1]);
+  lepton_list_add (list, &items[0]);
+  g_assert_cmpuint (g_list_length (lepton_list_get_glist (list)), ==, 3);
+
+  /* only the first occurrence is removed */
+  lepton_list_remove (list, &items[0]);
+  g_assert_true (lepton_list_contains (list, &items[0]));
+  g_assert_true (lepton_list_get_glist (list)->data == &items[1]);
+
+  lepton_list_remove (list, &items[0]);
+  g_assert_false (lepton_list_contains (list, &items[0]));
+  g_assert_cmpuint (g_list_length (lepton_list_get_glist (list)), ==, 1);
+
+  g_object_unref (list);
+}
+
+void
+check_update ()
+{
+  gint items[3];
+  gint changed = 0;
+  LeptonList *list = lepton_list_new ();
+
+  g_signal_connect (list, "changed", G_CALLBACK (count_changed), &changed);
+
+  lepton_list_add (list, &items[0]);
+  g_assert_cmpint (changed, ==, 1);
+
+  /* nested updates emit one signal at the outermost level */
+  lepton_list_begin_update (list);
+  lepton_list_begin_update (list);
+  lepton_list_add (list, &items[1]);
+  lepton_list_add (list, &items[2]);
+  lepton_list_end_update (list);
+  lepton_list_remove (list, &items[0]);
+  g_assert_cmpint (changed, ==, 1);
+  lepton_list_end_update (list);
+  g_assert_cmpint (changed, ==, 2);
+
+  /* an update without changes emits nothing */
+  lepton_list_begin_update (list);
+  lepton_list_remove (list, &items[0]);
+  lepton_list_end_update (list);
+  g_assert_cmpint (changed, ==, 2);
+
+  g_object_unref (list);
+}
+
+void
+check_item_signals ()
+{
+  gint items[2] = { 0, 0 };
+  gint removed[2] = { 0, 0 };
+  LeptonList *list = lepton_list_new ();
+
+  g_signal_connect (list, "item-added", G_CALLBACK (count_item), NULL);
+
+  /* item signals are not postponed by updates */
+  lepton_list_begin_update (list);
+  lepton_list_add (list, &items[0]);
+  lepton_list_add (list, &items[1]);
+  g_assert_cmpint (items[0], ==, 1);
+  g_assert_cmpint (items[1], ==, 1);
+  lepton_list_end_update (list);
+
+  g_signal_handlers_disconnect_by_func (list, (gpointer) count_item, NULL);
+  g_signal_connect (list, "item-removed", G_CALLBACK (count_item), NULL);
+
+  lepton_list_remove (list, &items[0]);
+  g_assert_cmpint (items[0], ==, 2);
+  g_assert_cmpint (items[1], ==, 1);
+
+  lepton_list_add (list, &removed[0]);
+  lepton_list_add (list, &removed[1]);
+  lepton_list_remove_all (list);
+  g_assert_cmpint (items[1], ==, 2);
+  g_assert_cmpint (removed[0], ==, 1);
+  g_assert_cmpint (removed[1], ==, 1);
+
+  g_object_unref (list);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/geda/liblepton/list/order",
+                   check_order);
+
+  g_test_add_func ("/geda/liblepton/list/contains",
+                   check_contains);
+
+  g_test_add_func ("/geda/liblepton/list/duplicates",
+                   check_duplicates);
+
+  g_test_add_func ("/geda/liblepton/list/update",
+                   check_update);
+
+  g_test_add_func ("/geda/liblepton/list/item_signals",
+                   check_item_signals);
+
+  return g_test_run ();
+}
@@ -0,0 +1,302 @@
+#include <glib.h>
+#include <liblepton.h>
+
+/* Size of the page's spatial index cells, see page.c */
+#define CELL_SIZE 1024
+
+/* Number of cells along each side of the filler grid.  The grid
+ * makes enough cells used that small queries go through the index
+ * rather than falling back to scanning the object list. */
+#define GRID_SIZE 10
+
+
+/* Creates a box lying in the middle of the cell at the given cell
+ * coordinates. */
+static LeptonObject*
+new_box (int cell_x, int cell_y)
+{
+  int x = cell_x * CELL_SIZE;
+  int y = cell_y * CELL_SIZE;
+
+  return lepton_box_object_new (GRAPHIC_COLOR,
+                                x + 100,
+                                y + 900,
+                                x + 900,
+                                y + 100);
+}
+
+
+static LeptonBox
+cell_rect (int cell_x, int cell_y)
+{
+  LeptonBox rect;
+
+  rect.lower_x = cell_x * CELL_SIZE + 1;
+  rect.lower_y = cell_y * CELL_SIZE + 1;
+  rect.upper_x = cell_x * CELL_SIZE + CELL_SIZE - 2;
+  rect.upper_y = cell_y * CELL_SIZE + CELL_SIZE - 2;
+
+  return rect;
+}
+
+
+static LeptonPage*
+setup_page (LeptonToplevel *toplevel)
+{
+  LeptonPage *page = lepton_page_new (toplevel, "test_page_index.sch");
+  int x, y;
+
+  lepton_toplevel_set_page_current (toplevel, page);
+
+  for (x = 0; x < GRID_SIZE; x++) {
+    for (y = 0; y < GRID_SIZE; y++) {
+      lepton_page_append (page, new_box (x, y));
+    }
+  }
+
+  return page;
+}
+
+
+/* Checks that the objects found in the given cell are exactly the
+ * NULL terminated list of expected objects, in order. */
+static void
+assert_in_cell (LeptonPage *page, int cell_x, int cell_y, ...)
+{
+  LeptonBox rect = cell_rect (cell_x, cell_y);
+  GList *found = lepton_page_objects_in_regions (page, &rect, 1, TRUE);
+  GList *iter = found;
+  LeptonObject *expected;
+  va_list args;
+
+  va_start (args, cell_y);
+  while ((expected = va_arg (args, LeptonObject*)) != NULL) {
+    g_assert_nonnull (iter);
+    g_assert_true (iter->data == expected);
+    iter = g_list_next (iter);
+  }
+  va_end (args);
+
+  g_assert_null (iter);
+  g_list_free (found);
+}
+
+
+void
+check_add_remove_replace ()
+{
+  LeptonToplevel *toplevel = lepton_toplevel_new ();
+  LeptonPage *page = setup_page (toplevel);
+  LeptonObject *a = new_box (20, 20);
+  LeptonObject *b = new_box (20, 20);
+  LeptonObject *c = new_box (20, 20);
+  LeptonObject *d = new_box (20, 20);
+  LeptonBox rects[2];
+  GList *found;
+
+  assert_in_cell (page, 20, 20, NULL);
+
+  lepton_page_append (page, a);
+  lepton_page_append (page, b);
+  lepton_page_append (page, c);
+  assert_in_cell (page, 20, 20, a, b, c, NULL);
+  assert_in_cell (page, 0, 0,
+                  g_list_nth_data ((GList*) lepton_page_objects (page), 0),
+                  NULL);
+
+  lepton_page_remove (page, b);
+  assert_in_cell (page, 20, 20, a, c, NULL);
+
+  /* The replacement keeps the position of the replaced object */
+  lepton_page_replace (page, a, d);
+  assert_in_cell (page, 20, 20, d, c, NULL);
+
+  lepton_page_append (page, b);
+  assert_in_cell (page, 20, 20, d, c, b, NULL);
+
+  lepton_page_replace (page, c, a);
+  assert_in_cell (page, 20, 20, d, a, b, NULL);
+
+  /* An object found in several regions is only returned once */
+  rects[0] = cell_rect (20, 20);
+  rects[1] = cell_rect (20, 20);
+  found = lepton_page_objects_in_regions (page, rects, 2, TRUE);
+  g_assert_cmpuint (g_list_length (found), ==, 3);
+  g_list_free (found);
+
+  lepton_object_delete (c);
+  lepton_toplevel_delete (toplevel);
+}
+
+
+void
+check_move ()
+{
+  LeptonToplevel *toplevel = lepton_toplevel_new ();
+  LeptonPage *page = setup_page (toplevel);
+  LeptonObject *a = new_box (20, 20);
+  LeptonObject *b = new_box (25, 20);
+  LeptonObject *c = new_box (20, 20);
+
+  lepton_page_append (page, a);
+  lepton_page_append (page, b);
+  lepton_page_append (page, c);
+  assert_in_cell (page, 20, 20, a, c, NULL);
+  assert_in_cell (page, 25, 20, b, NULL);
+
+  /* Moving an object into another cell */
+  lepton_object_translate (a, 5 * CELL_SIZE, 0);
+  assert_in_cell (page, 20, 20, c, NULL);
+  assert_in_cell (page, 25, 20, a, b, NULL);
+
+  /* Stretching an object over a neighbouring cell */
+  lepton_box_object_modify (c,
+                            21 * CELL_SIZE + 500,
+                            20 * CELL_SIZE + 100,
+                            BOX_LOWER_RIGHT);
+  assert_in_cell (page, 20, 20, c, NULL);
+  assert_in_cell (page, 21, 20, c, NULL);
+
+  /* Moving it back */
+  lepton_object_translate (a, -5 * CELL_SIZE, 0);
+  assert_in_cell (page, 20, 20, a, c, NULL);
+  assert_in_cell (page, 25, 20, b, NULL);
+
+  lepton_toplevel_delete (toplevel);
+}
+
+
+void
+check_large ()
+{
+  LeptonToplevel *toplevel = lepton_toplevel_new ();
+  LeptonPage *page = setup_page (toplevel);
+  LeptonObject *a = new_box (20, 20);
+  LeptonObject *b = new_box (20, 20);
+  LeptonObject *big = lepton_box_object_new (GRAPHIC_COLOR,
+                                             10 * CELL_SIZE,
+                                             40 * CELL_SIZE,
+                                             40 * CELL_SIZE,
+                                             10 * CELL_SIZE);
+
+  lepton_page_append (page, a);
+  lepton_page_append (page, big);
+  lepton_page_append (page, b);
+
+  /* The box spans many more cells than are in use, but is still
+   * found everywhere inside its bounds, in page order. */
+  assert_in_cell (page, 20, 20, a, big, b, NULL);
+  assert_in_cell (page, 35, 35, big, NULL);
+  assert_in_cell (page, 50, 50, NULL);
+
+  /* Shrinking the box makes it a small object */
+  lepton_box_object_modify (big,
+                            11 * CELL_SIZE + 100,
+                            11 * CELL_SIZE + 100,
+                            BOX_LOWER_LEFT);
+  lepton_box_object_modify (big,
+                            11 * CELL_SIZE + 900,
+                            11 * CELL_SIZE + 900,
+                            BOX_UPPER_RIGHT);
+  assert_in_cell (page, 20, 20, a, b, NULL);
+  assert_in_cell (page, 11, 11, big, NULL);
+
+  /* and growing it makes it large again */
+  lepton_box_object_modify (big,
+                            40 * CELL_SIZE,
+                            40 * CELL_SIZE,
+                            BOX_UPPER_RIGHT);
+  assert_in_cell (page, 20, 20, a, big, b, NULL);
+
+  lepton_page_remove (page, big);
+  assert_in_cell (page, 20, 20, a, b, NULL);
+
+  lepton_object_delete (big);
+  lepton_toplevel_delete (toplevel);
+}
+
+
+/* Checks that the objects found at the given point are exactly the
+ * NULL terminated list of expected objects, in order. */
+static void
+assert_at_point (LeptonPage *page,
+                 int x,
+                 int y,
+                 int slack,
+                 LeptonObject *after,
+                 ...)
+{
+  GList *found = lepton_page_objects_at_point (page, x, y, slack, after);
+  GList *iter = found;
+  LeptonObject *expected;
+  va_list args;
+
+  va_start (args, after);
+  while ((expected = va_arg (args, LeptonObject*)) != NULL) {
+    g_assert_nonnull (iter);
+    g_assert_true (iter->data == expected);
+    iter = g_list_next (iter);
+  }
+  va_end (args);
+
+  g_assert_null (iter);
+  g_list_free (found);
+}
+
+
+void
+check_at_point ()
+{
+  LeptonToplevel *toplevel = lepton_toplevel_new ();
+  LeptonPage *page = setup_page (toplevel);
+  LeptonObject *a = new_box (20, 20);
+  LeptonObject *b = new_box (20, 20);
+  LeptonObject *c = new_box (20, 20);
+  LeptonObject *d = new_box (30, 30);
+  int x = 20 * CELL_SIZE + 500;
+  int y = 20 * CELL_SIZE + 500;
+
+  lepton_page_append (page, a);
+  lepton_page_append (page, b);
+  lepton_page_append (page, d);
+  lepton_page_append (page, c);
+
+  /* The objects following the given one come first, the list
+   * wraps around and the given one is the last. */
+  assert_at_point (page, x, y, 10, NULL, a, b, c, NULL);
+  assert_at_point (page, x, y, 10, a, b, c, a, NULL);
+  assert_at_point (page, x, y, 10, b, c, a, b, NULL);
+  assert_at_point (page, x, y, 10, c, a, b, c, NULL);
+
+  /* Starting after an object which is not at the point */
+  assert_at_point (page, x, y, 10, d, c, a, b, NULL);
+
+  /* The order is kept when the object list is changed */
+  lepton_page_remove (page, b);
+  lepton_page_append (page, b);
+  assert_at_point (page, x, y, 10, a, c, b, a, NULL);
+  assert_at_point (page, x, y, 10, b, a, c, b, NULL);
+
+  lepton_toplevel_delete (toplevel);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/geda/liblepton/page_index/add_remove_replace",
+                   check_add_remove_replace);
+
+  g_test_add_func ("/geda/liblepton/page_index/move",
+                   check_move);
+
+  g_test_add_func ("/geda/liblepton/page_index/large",
+                   check_large);
+
+  g_test_add_func ("/geda/liblepton/page_index/at_point",
+                   check_at_point);
+
+  return g_test_run ();
+}
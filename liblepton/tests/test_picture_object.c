@@ -0,0 +1,133 @@
+#include <glib.h>
+#include <liblepton.h>
+
+/* Private liblepton API used to build the test data. */
+gchar* s_encoding_base64_encode (gchar* src, guint srclen, guint* dstlenp, gboolean strict);
+
+#define HEADER "G 100 200 300 400 0 0 1\nimage.png\n"
+
+
+/* Returns a copy of \a encoded with each line feed replaced with
+ * \a newline, and the lines rewrapped to \a width characters if
+ * \a width is positive.  The last line is always terminated. */
+static gchar*
+reformat (const gchar *encoded, const gchar *newline, int width)
+{
+  GString *result = g_string_new ("");
+  int column = 0;
+  const gchar *p;
+
+  for (p = encoded; *p != '\0'; p++) {
+    if (*p == '\n') {
+      if (width <= 0) {
+        g_string_append (result, newline);
+      }
+      continue;
+    }
+
+    if (width > 0 && column == width) {
+      g_string_append (result, newline);
+      column = 0;
+    }
+
+    g_string_append_c (result, *p);
+    column++;
+  }
+
+  if (width > 0 || (p > encoded && p[-1] != '\n')) {
+    g_string_append (result, newline);
+  }
+
+  return g_string_free (result, FALSE);
+}
+
+
+/* Reads a picture from \a data and returns its string
+ * representation. */
+static gchar*
+round_trip (const gchar *data)
+{
+  TextBuffer *tb = s_textbuffer_new (data, -1, NULL);
+  const gchar *first_line = s_textbuffer_next_line (tb);
+  gchar *line = g_strdup (first_line);
+  GError *error = NULL;
+  LeptonObject *object;
+  gchar *out;
+
+  object = lepton_picture_object_read (line, tb, 0, 0, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (object);
+  g_assert_true (lepton_picture_object_get_embedded (object));
+
+  out = lepton_picture_object_to_buffer (object);
+
+  lepton_object_delete (object);
+  g_free (line);
+  s_textbuffer_free (tb);
+
+  return out;
+}
+
+
+void
+check_embedded_round_trip ()
+{
+  static const gchar *newlines[] = { "\n", "\r\n", "\r" };
+  static const int widths[] = { 0, 1, 40, 76, 200 };
+  gchar content[300];
+  gchar *encoded;
+  gchar *expected;
+  guint length;
+  guint i, j;
+
+  for (i = 0; i < sizeof (content); i++) {
+    content[i] = (gchar) (i * 7 + 3);
+  }
+
+  encoded = s_encoding_base64_encode (content,
+                                      sizeof (content),
+                                      &length,
+                                      TRUE);
+  g_assert_nonnull (encoded);
+
+  /* The canonical representation written on save */
+  expected = g_strconcat (HEADER, encoded, "\n.", NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (newlines); i++) {
+    for (j = 0; j < G_N_ELEMENTS (widths); j++) {
+      gchar *body = reformat (encoded, newlines[i], widths[j]);
+      gchar *header = reformat (HEADER, newlines[i], 0);
+      gchar *data = g_strconcat (header, body, ".", newlines[i], NULL);
+      gchar *out = round_trip (data);
+
+      g_assert_cmpstr (out, ==, expected);
+
+      /* Saving again gives the same result */
+      g_free (data);
+      data = g_strconcat (out, "\n", NULL);
+      g_free (out);
+      out = round_trip (data);
+      g_assert_cmpstr (out, ==, expected);
+
+      g_free (out);
+      g_free (data);
+      g_free (header);
+      g_free (body);
+    }
+  }
+
+  g_free (expected);
+  g_free (encoded);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/geda/liblepton/picture_object/embedded_round_trip",
+                   check_embedded_round_trip);
+
+  return g_test_run ();
+}
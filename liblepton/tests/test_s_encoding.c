@@ -0,0 +1,552 @@
+#include <liblepton.h>
+
+/* Private liblepton API under test. */
+gchar* s_encoding_base64_encode (gchar* src, guint srclen, guint* dstlenp, gboolean strict);
+gchar* s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp);
+gboolean s_encoding_set_vectorized (gboolean enable);
+
+/* Tests for the Base64 codec in s_encoding.c.
+ *
+ * The codec is compared with the previous byte-at-a-time
+ * implementation which is kept below for reference.  The tests are
+ * run both with the scalar codecs and with the vectorized ones
+ * where the processor supports them.  Run the
+ * program with "-m perf" to also benchmark both implementations on
+ * multi-megabyte inputs:
+ *
+ *   ./test_s_encoding -m perf --verbose
+ */
+
+/* ================================================================
+ * Reference implementation
+ * ================================================================ */
+
+static gchar reference_Base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+#define reference_Pad64	'='
+static guchar reference_Base64_rank[256] = {
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0x00-0x0f	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0x10-0x1f	*/
+	255,255,255,255,255,255,255,255,255,255,255, 62,255,255,255, 63, /*	0x20-0x2f	*/
+	 52, 53, 54, 55, 56, 57, 58, 59, 60, 61,255,255,255,255,255,255, /*	0x30-0x3f	*/
+	255,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, /*	0x40-0x4f	*/
+	 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,255,255,255,255,255, /*	0x50-0x5f	*/
+	255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, /*	0x60-0x6f	*/
+	 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,255,255,255,255,255, /*	0x70-0x7f	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0x80-0x8f	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0x90-0x9f	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xa0-0xaf	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xb0-0xbf	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xc0-0xcf	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xd0-0xdf	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xe0-0xef	*/
+	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255, /*	0xf0-0xff	*/
+};
+
+/*! \brief Convert a buffer from binary to base64 representation.
+ *  \par Function Description
+ *  Convert a buffer from binary to base64 representation.  Set
+ *  <B>strict</B> to TRUE to insert a newline every 72th character.  This is
+ *  required by RFC 2045, but some applications don't require this.
+ *  
+ *  \param [in]  src      Source buffer.
+ *  \param [in]  srclen   Length of source buffer.
+ *  \param [out] dstlenp  Length of buffer returned
+ *                        (including the terminating \\0).
+ *  \param [in]  strict   Insert new lines as required by RFC 2045.
+ *  \return Caller owned buffer containing base64 representation.
+ */
+static gchar*
+reference_base64_encode (gchar* src, guint srclen, 
+				 guint* dstlenp, gboolean strict) 
+{
+  gchar* dst;
+  guint dstpos;
+  guchar input[3];
+  guchar output[4];
+  guint ocnt;
+  guint i;
+
+  if (srclen == 0) 
+    return NULL;	/* FIX: Or return ""? */
+
+  /* Calculate required length of dst.  4 bytes of dst are needed for
+     every 3 bytes of src. */
+  *dstlenp = (((srclen + 2) / 3) * 4)+5;
+  if (strict)
+    *dstlenp += (*dstlenp / 72);	/* Handle trailing \n */
+
+  dst = g_new(gchar, *dstlenp );
+
+  /* bulk encoding */
+  dstpos = 0;
+  ocnt = 0;
+  while (srclen >= 3) 
+    {
+      /*
+	Convert 3 bytes of src to 4 bytes of output
+
+	output[0] = input[0] 7:2
+	output[1] = input[0] 1:0 input[1] 7:4
+	output[2] = input[1] 3:0 input[2] 7:6
+	output[3] = input[1] 5:0
+
+       */
+      input[0] = *src++;
+      input[1] = *src++;
+      input[2] = *src++;
+      srclen -= 3;
+
+      output[0] = (input[0] >> 2);
+      output[1] = ((input[0] & 0x03) << 4) + 
+	(input[1] >> 4);
+      output[2] = ((input[1] & 0x0f) << 2) + 
+	(input[2] >> 6);
+      output[3] = (input[2] & 0x3f);
+
+      g_assert ((dstpos + 4) < *dstlenp);
+
+      /* Map output to the Base64 alphabet */
+      dst[dstpos++] = reference_Base64[(guint) output[0]];
+      dst[dstpos++] = reference_Base64[(guint) output[1]];
+      dst[dstpos++] = reference_Base64[(guint) output[2]];
+      dst[dstpos++] = reference_Base64[(guint) output[3]];
+
+      /* Add a newline if strict and  */
+      if (strict)
+	if ((++ocnt % (72/4)) == 0) 
+	  dst[dstpos++] = '\n';
+    }
+
+  /* Now worry about padding with remaining 1 or 2 bytes */
+  if (srclen != 0) 
+    {
+      input[0] = input[1] = input[2] = '\0';
+      for (i = 0; i < srclen; i++) 
+	input[i] = *src++;
+
+      output[0] = (input[0] >> 2);
+      output[1] = ((input[0] & 0x03) << 4) + 
+	(input[1] >> 4);
+      output[2] = ((input[1] & 0x0f) << 2) + 
+	(input[2] >> 6);
+
+      g_assert ((dstpos + 4) < *dstlenp);
+
+      dst[dstpos++] = reference_Base64[(guint) output[0]];
+      dst[dstpos++] = reference_Base64[(guint) output[1]];
+
+      if (srclen == 1)
+	dst[dstpos++] = reference_Pad64;
+      else
+	dst[dstpos++] = reference_Base64[(guint) output[2]];
+
+      dst[dstpos++] = reference_Pad64;
+    }
+
+  g_assert (dstpos <= *dstlenp);
+
+  dst[dstpos] = '\0';
+
+  *dstlenp = dstpos + 1;
+
+  return dst;
+}
+
+/*! \brief Convert a buffer from base64 to binary representation.
+ *  \par Function Description
+ *  Convert a buffer from base64 to binary representation.  This
+ *  function is liberal in what it will accept.  It ignores non-base64
+ *  symbols.
+ *  
+ *  \param [in]  src      Source buffer.
+ *  \param [in]  srclen   Length of the source buffer.
+ *  \param [out] dstlenp  Pointer to length of the destination buffer
+ *  \return Caller-owned buffer with binary representation.
+ *          The integer pointed to by <B>dstlenp</B> is set to the length
+ *          of that buffer.
+ */
+static gchar*
+reference_base64_decode (gchar* src, guint srclen, guint* dstlenp)
+{
+
+  gchar* dst;
+  guint   dstidx, state, ch = 0;
+  gchar  res;
+  guchar pos;
+
+  if (srclen == 0) 
+    srclen = strlen(src);
+  state = 0;
+  dstidx = 0;
+  res = 0;
+
+  dst = g_new(gchar, srclen+1);
+  *dstlenp = srclen+1;
+
+  while (srclen > 0)
+    {
+      srclen--;
+      ch = (guchar) *src++;
+      if (ch == reference_Pad64) 
+	break;
+      if (reference_Base64_rank[ch]==255) /* Skip any non-base64 anywhere */
+	continue;
+
+      pos = reference_Base64_rank[ch];
+
+      switch (state) 
+	{
+	case 0:
+	  dst[dstidx] = (pos << 2);
+	  state = 1;
+	  break;
+	case 1:
+	  dst[dstidx] |= (pos >> 4);
+	  res = ((pos & 0x0f) << 4);
+	  dstidx++;
+	  state = 2;
+	  break;
+	case 2:
+	  dst[dstidx] = res | (pos >> 2);
+	  res = (pos & 0x03) << 6;
+	  dstidx++;
+	  state = 3;
+	  break;
+	case 3:
+	  dst[dstidx] = res | pos;
+	  dstidx++;
+	  state = 0;
+	  break;
+	default:
+	  break;
+	}
+    }
+  /*
+   * We are done decoding Base-64 chars.  Let's see if we ended
+   * on a byte boundary, and/or with erroneous trailing characters.
+   */
+  if (ch == reference_Pad64)           /* We got a pad char. */
+    {
+      switch (state) 
+	{
+	case 0:             /* Invalid = in first position */
+	case 1:             /* Invalid = in second position */
+	  g_free(dst);
+	  return NULL;
+	case 2:             /* Valid, means one byte of info */
+                                /* Skip any number of spaces. */
+	  while (srclen > 0)
+	    {
+	      srclen--;
+	      ch = (guchar) *src++;
+	      if (ch == reference_Pad64) break;
+	      if (reference_Base64_rank[ch] != 255) break;
+	    }
+                                /* Make sure there is another trailing = sign. */
+	  if (ch != reference_Pad64) 
+	    {
+	      g_free(dst);
+	      *dstlenp = 0;
+	      return NULL;
+	    }
+                                /* FALLTHROUGH */
+	case 3:             /* Valid, means two bytes of info */
+                                /*
+                                 * We know this char is an =.  Is there anything but
+                                 * whitespace after it?
+                                 */
+	  while (srclen > 0)
+	    {
+	      srclen--;
+	      ch = (guchar) *src++;
+	      if (reference_Base64_rank[ch] != 255) 
+		{
+		  g_free(dst);
+		  *dstlenp = 0;
+		  return NULL;
+		}
+	    }
+                                /*
+                                 * Now make sure for cases 2 and 3 that the "extra"
+                                 * bits that slopped past the last full byte were
+                                 * zeros.  If we don't check them, they become a
+                                 * subliminal channel.
+                                 */
+	  if (res != 0)
+	    {
+	      g_free(dst);
+	      *dstlenp = 0;
+	      return NULL;
+	    }
+	default:
+	  break;
+	}
+    } else 
+      {
+	/*
+	 * We ended by seeing the end of the string.  Make sure we
+	 * have no partial bytes lying around.
+	 */
+	if (state != 0) 
+	  {
+	    g_free(dst);
+	    *dstlenp = 0;
+	    return NULL;
+	  }
+      }
+  dst[dstidx]=0;
+  *dstlenp = dstidx;
+  return dst;
+}
+
+
+/* ================================================================
+ * Tests
+ * ================================================================ */
+
+/* Selects the codecs to test.  \a data is non-NULL to test the
+ * vectorized codecs.  Returns FALSE if they are not supported. */
+static gboolean
+select_codecs (gconstpointer data)
+{
+  gboolean vectorized = (data != NULL);
+
+  if (s_encoding_set_vectorized (vectorized) != vectorized) {
+    g_test_skip ("vectorized codecs are not supported");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static gchar*
+random_buffer (GRand *rand, guint len)
+{
+  gchar *buf = g_new (gchar, len + 1);
+  guint i;
+
+  for (i = 0; i < len; i++) {
+    buf[i] = (gchar) g_rand_int_range (rand, 0, 256);
+  }
+  buf[len] = '\0';
+  return buf;
+}
+
+static void
+check_encode (gchar *src, guint len, gboolean strict)
+{
+  guint actual_len = 0, expected_len = 0;
+  gchar *actual = s_encoding_base64_encode (src, len, &actual_len, strict);
+  gchar *expected = reference_base64_encode (src, len, &expected_len, strict);
+
+  if (expected == NULL) {
+    g_assert_null (actual);
+  } else {
+    g_assert_nonnull (actual);
+    g_assert_cmpuint (actual_len, ==, expected_len);
+    g_assert_cmpstr (actual, ==, expected);
+  }
+  g_free (actual);
+  g_free (expected);
+}
+
+static void
+check_decode (gchar *src, guint len)
+{
+  guint actual_len = 0, expected_len = 0;
+  gchar *actual = s_encoding_base64_decode (src, len, &actual_len);
+  gchar *expected = reference_base64_decode (src, len, &expected_len);
+
+  g_assert_cmpuint (actual_len, ==, expected_len);
+  if (expected == NULL) {
+    g_assert_null (actual);
+  } else {
+    g_assert_nonnull (actual);
+    g_assert_cmpmem (actual, actual_len, expected, expected_len);
+  }
+  g_free (actual);
+  g_free (expected);
+}
+
+void
+check_encode_sizes (gconstpointer data)
+{
+  GRand *rand;
+  guint len;
+
+  if (!select_codecs (data))
+    return;
+  rand = g_rand_new_with_seed (1);
+
+  /* Cover all positions of the last group relative to line
+   * breaks and vector blocks. */
+  for (len = 0; len < 1000; len++) {
+    gchar *src = random_buffer (rand, len);
+    check_encode (src, len, TRUE);
+    check_encode (src, len, FALSE);
+    g_free (src);
+  }
+  g_rand_free (rand);
+}
+
+void
+check_decode_roundtrip (gconstpointer data)
+{
+  GRand *rand;
+  guint len;
+
+  if (!select_codecs (data))
+    return;
+  rand = g_rand_new_with_seed (2);
+
+  for (len = 1; len < 1000; len++) {
+    gchar *src = random_buffer (rand, len);
+    guint encoded_len, decoded_len;
+    gchar *encoded = s_encoding_base64_encode (src, len, &encoded_len, TRUE);
+    gchar *decoded = s_encoding_base64_decode (encoded, encoded_len - 1,
+                                               &decoded_len);
+
+    g_assert_cmpmem (decoded, decoded_len, src, len);
+    check_decode (encoded, encoded_len - 1);
+
+    g_free (decoded);
+    g_free (encoded);
+    g_free (src);
+  }
+  g_rand_free (rand);
+}
+
+void
+check_decode_garbage (gconstpointer data)
+{
+  static const gchar garbage[] = "=\n\r !A+/*";
+  GRand *rand;
+  guint len;
+  gint i;
+
+  if (!select_codecs (data))
+    return;
+  rand = g_rand_new_with_seed (3);
+
+  /* Damage valid input in random places, the results and errors
+   * must be the same as with the reference implementation. */
+  for (len = 1; len < 500; len++) {
+    gchar *src = random_buffer (rand, len);
+    guint encoded_len;
+    gchar *encoded = s_encoding_base64_encode (src, len, &encoded_len, TRUE);
+
+    for (i = 0; i < 10; i++) {
+      gchar *damaged = g_strdup (encoded);
+      gint pos = g_rand_int_range (rand, 0, encoded_len - 1);
+      damaged[pos] = garbage[g_rand_int_range (rand, 0, sizeof (garbage) - 1)];
+      check_decode (damaged, encoded_len - 1);
+      g_free (damaged);
+    }
+
+    g_free (encoded);
+    g_free (src);
+  }
+  g_rand_free (rand);
+
+  check_decode ("", 0);
+  check_decode ("=", 1);
+  check_decode ("QQ==", 4);
+  check_decode ("QQ=", 3);
+  check_decode ("QR==", 4);
+  check_decode ("QUI=", 4);
+  check_decode ("QUI=QQ", 6);
+  check_decode ("Q\nU\nJ\nD", 7);
+}
+
+void
+check_performance ()
+{
+  GRand *rand = g_rand_new_with_seed (4);
+  guint len = 8 * 1024 * 1024;
+  gchar *src = random_buffer (rand, len);
+  gchar *encoded, *decoded;
+  guint encoded_len, decoded_len;
+  gdouble reference, current;
+  gint i, rounds = 10;
+
+  /* Measure the codecs selected by default. */
+  s_encoding_set_vectorized (TRUE);
+
+  g_test_timer_start ();
+  for (i = 0; i < rounds; i++) {
+    g_free (reference_base64_encode (src, len, &encoded_len, TRUE));
+  }
+  reference = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (i = 0; i < rounds; i++) {
+    g_free (s_encoding_base64_encode (src, len, &encoded_len, TRUE));
+  }
+  current = g_test_timer_elapsed ();
+
+  g_test_message ("encode %u bytes: reference %.1f MB/s, current %.1f MB/s",
+                  len,
+                  rounds * len / reference / 1e6,
+                  rounds * len / current / 1e6);
+  g_test_maximized_result (rounds * len / current / 1e6,
+                           "encode %.1f MB/s",
+                           rounds * len / current / 1e6);
+
+  encoded = s_encoding_base64_encode (src, len, &encoded_len, TRUE);
+
+  g_test_timer_start ();
+  for (i = 0; i < rounds; i++) {
+    g_free (reference_base64_decode (encoded, encoded_len - 1, &decoded_len));
+  }
+  reference = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (i = 0; i < rounds; i++) {
+    decoded = s_encoding_base64_decode (encoded, encoded_len - 1, &decoded_len);
+    g_assert_cmpuint (decoded_len, ==, len);
+    g_free (decoded);
+  }
+  current = g_test_timer_elapsed ();
+
+  g_test_message ("decode %u bytes: reference %.1f MB/s, current %.1f MB/s",
+                  encoded_len,
+                  rounds * encoded_len / reference / 1e6,
+                  rounds * encoded_len / current / 1e6);
+  g_test_maximized_result (rounds * encoded_len / current / 1e6,
+                           "decode %.1f MB/s",
+                           rounds * encoded_len / current / 1e6);
+
+  g_free (encoded);
+  g_free (src);
+  g_rand_free (rand);
+}
+
+int
+main (int argc, char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/scalar/encode_sizes",
+                          NULL, check_encode_sizes);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/scalar/decode_roundtrip",
+                          NULL, check_decode_roundtrip);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/scalar/decode_garbage",
+                          NULL, check_decode_garbage);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/vectorized/encode_sizes",
+                          GINT_TO_POINTER (TRUE), check_encode_sizes);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/vectorized/decode_roundtrip",
+                          GINT_TO_POINTER (TRUE), check_decode_roundtrip);
+
+    g_test_add_data_func ("/geda/liblepton/s_encoding/vectorized/decode_garbage",
+                          GINT_TO_POINTER (TRUE), check_decode_garbage);
+
+    if (g_test_perf ()) {
+      g_test_add_func ("/geda/liblepton/s_encoding/performance",
+                       check_performance);
+    }
+
+    return g_test_run ();
+}
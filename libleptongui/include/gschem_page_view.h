@@ -29,6 +29,9 @@
 #define GSCHEM_IS_PAGE_VIEW(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GSCHEM_TYPE_PAGE_VIEW))
 #define GSCHEM_PAGE_VIEW_GET_CLASS(obj) (G_TYPE_INSTANCE_GET_CLASS ((obj), GSCHEM_TYPE_PAGE_VIEW, GschemPageViewClass))
 
+/* Width and height of cached page tiles in pixels */
+#define GSCHEM_PAGE_VIEW_TILE_SIZE 128
+
 typedef struct _GschemPageViewClass GschemPageViewClass;
 typedef struct _GschemPageView GschemPageView;
 
@@ -64,6 +67,16 @@ struct _GschemPageView
   LeptonPage *_page;
 
   GHashTable *_geometry_cache;
+
+  /* Rendered tiles of the page layer, see o_redraw_rect() */
+  GHashTable *_tile_cache;
+  GQueue *_tile_lru;
+  int _tile_flags;
+
+  /* Damaged world rectangles not yet redrawn, see
+   * gschem_page_view_damage_world_rect() */
+  GArray *_damage;
+  guint _damage_source;
 };
 
 
@@ -87,15 +100,34 @@ gschem_page_view_get_vadjustment (GschemPageView *view);
 gboolean
 gschem_page_view_get_show_hidden_text (GschemPageView *view);
 
+void
+gschem_page_view_damage_world_rect (GschemPageView *view, int left, int top, int right, int bottom);
+
 void
 gschem_page_view_invalidate_all (GschemPageView *view);
 
+void
+gschem_page_view_invalidate_window (GschemPageView *view);
+
 void
 gschem_page_view_invalidate_screen_rect (GschemPageView *view, int left, int top, int right, int bottom);
 
 void
 gschem_page_view_invalidate_world_rect (GschemPageView *view, int left, int top, int right, int bottom);
 
+void
+gschem_page_view_insert_tile (GschemPageView *view,
+                              int column,
+                              int row,
+                              int flags,
+                              cairo_surface_t *surface);
+
+cairo_surface_t*
+gschem_page_view_lookup_tile (GschemPageView *view,
+                              int column,
+                              int row,
+                              int flags);
+
 GschemPageView*
 gschem_page_view_new_with_page (LeptonPage *page);
 
@@ -53,6 +53,8 @@ struct _GschemSelectionAdapter
 
   LeptonSelection *selection;
   LeptonToplevel *toplevel;
+
+  struct st_selection_aggregates *aggregates;
 };
 
 GType
@@ -229,6 +229,12 @@ struct st_gschem_toplevel {
   /* Minimum grid line pitch to display. Applies to major and minor lines. */
   int mesh_grid_display_threshold;
 
+  /* Minimum size in pixels of text and hatch pitch drawn in full
+   * detail. */
+  int lod_size;
+  /* Minimum size in pixels of symbols whose contents are drawn. */
+  int lod_symbol_size;
+
   int mousepan_gain;      /* Controls the gain of the mouse pan */
   int keyboardpan_gain;   /* Controls the gain of the keyboard pan */
   int select_slack_pixels; /* Number of pixels around an object we can still select it with */
@@ -43,6 +43,8 @@ extern int default_dots_grid_dot_size;
 extern int default_dots_grid_mode;
 extern int default_dots_grid_fixed_threshold;
 extern int default_mesh_grid_display_threshold;
+extern int default_lod_size;
+extern int default_lod_symbol_size;
 extern int default_auto_save_interval;
 extern int default_mousepan_gain;
 extern int default_keyboardpan_gain;
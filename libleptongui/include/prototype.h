@@ -149,14 +149,14 @@ o_attrib_add_attrib (GschemToplevel *w_current,
 #ifdef ENABLE_GTK3
 void
 o_redraw_rect (GschemToplevel *w_current,
-               GtkWidget *widget,
+               GschemPageView *view,
                LeptonPage *page,
                GschemPageGeometry *geometry,
                cairo_t *cr);
 #else
 void
 o_redraw_rect (GschemToplevel *w_current,
-               GdkDrawable *drawable,
+               GschemPageView *view,
                LeptonPage *page,
                GschemPageGeometry *geometry,
                GdkRectangle *rectangle);
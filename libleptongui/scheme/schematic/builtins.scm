@@ -212,13 +212,19 @@
   (define *window (*current-window))
   (define show-hidden-text?
     (true? (gschem_toplevel_get_show_hidden_text *window)))
+  (define *selection
+    (lepton_page_get_selection_list (page->pointer (active-page))))
 
   (o_redraw_cleanstates *window)
 
-  (o_select_unselect_all *window)
-
-  (for-each select-visible-and-selectable!
-            (page-contents (active-page)))
+  ;; Notify about the new selection once.
+  (dynamic-wind
+    (lambda () (lepton_list_begin_update *selection))
+    (lambda ()
+      (o_select_unselect_all *window)
+      (for-each select-visible-and-selectable!
+                (page-contents (active-page))))
+    (lambda () (lepton_list_end_update *selection)))
 
   ;; Run hooks for all items selected.
   (let ((new-selection (page-selection (active-page))))
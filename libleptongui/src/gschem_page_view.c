@@ -44,6 +44,19 @@
 
 #define INVALIDATE_MARGIN 1
 
+/* Minimum number of page tiles kept in the tile cache */
+#define TILE_CACHE_MIN_SIZE 256
+
+/* Damage is flushed just before the view is redrawn */
+#define DAMAGE_PRIORITY (GDK_PRIORITY_REDRAW - 10)
+
+/* Above this number of damaged rectangles only their extents are
+ * redrawn */
+#define DAMAGE_COALESCE_LIMIT 256
+
+/* Maximum number of rectangles redrawn after coalescing damage */
+#define DAMAGE_MAX_RECTS 16
+
 
 
 enum
@@ -115,6 +128,39 @@ static void geometry_cache_dispose (GschemPageView *view);
 
 static void geometry_cache_finalize (GschemPageView *view);
 
+typedef struct _PageViewTile PageViewTile;
+
+/* A rendered square of the page layer.  Tiles are positioned in
+ * page pixel coordinates, that is, world coordinates scaled by
+ * the view scale with the y axis flipped, so they stay valid when
+ * the view is scrolled or panned. */
+struct _PageViewTile
+{
+  double scale_x;
+  double scale_y;
+  int column;
+  int row;
+  cairo_surface_t *surface;
+  GList *lru_link;
+};
+
+static gboolean
+tile_intersects_world_rect (const PageViewTile *tile,
+                            int min_x,
+                            int min_y,
+                            int max_x,
+                            int max_y);
+
+static void tile_cache_create (GschemPageView *view);
+
+static void tile_cache_flush (GschemPageView *view);
+
+static void tile_cache_finalize (GschemPageView *view);
+
+static void damage_clear (GschemPageView *view);
+
+static void damage_flush (GschemPageView *view);
+
 static GObjectClass *gschem_page_view_parent_class = NULL;
 
 
@@ -182,6 +228,8 @@ dispose (GObject *object)
   gschem_page_view_set_vadjustment (view, NULL);
 
   geometry_cache_dispose (view);
+  tile_cache_flush (view);
+  damage_clear (view);
 
   /* lastly, chain up to the parent dispose */
 
@@ -207,6 +255,24 @@ event_realize(GtkWidget *widget, gpointer unused)
 
 
 
+/*! \brief Event handler for window mapped
+ *  \par Function Description
+ *  Cached tiles may be stale if the page has been changed while
+ *  the view was hidden, e.g. in another tab, since only the
+ *  current page view is notified of changes.
+ */
+static void
+event_map (GtkWidget *widget, gpointer unused)
+{
+  GschemPageView *view = GSCHEM_PAGE_VIEW (widget);
+
+  g_return_if_fail (view != NULL);
+
+  tile_cache_flush (view);
+}
+
+
+
 /*! \brief Event handler for window unrealized
  */
 static void
@@ -241,6 +307,8 @@ finalize (GObject *object)
   g_return_if_fail (view != NULL);
 
   geometry_cache_finalize (view);
+  tile_cache_finalize (view);
+  g_array_free (view->_damage, TRUE);
 
   /* lastly, chain up to the parent finalize */
 
@@ -627,26 +695,44 @@ gschem_page_view_get_vadjustment (GschemPageView *view)
 
 
 /*! \brief Schedule redraw for the entire window
+ *  \par Function Description
+ *  Schedules redraw of the window without dropping cached page
+ *  tiles.  This is used when only the view geometry or things
+ *  drawn over the page, like objects being placed, change.
  *
  *  \param [in,out] view The Gschem page view to redraw
  */
 void
-gschem_page_view_invalidate_all (GschemPageView *view)
+gschem_page_view_invalidate_window (GschemPageView *view)
 {
-  GdkWindow *window;
+  GdkWindow *window = gtk_widget_get_window (GTK_WIDGET (view));
 
-  /* this function can be called early during initialization */
-  if (view == NULL) {
+  if (window == NULL) {
     return;
   }
 
-  window = gtk_widget_get_window (GTK_WIDGET (view));
+  gdk_window_invalidate_rect (window, NULL, FALSE);
+}
 
-  if (window == NULL) {
+
+/*! \brief Schedule redraw for the entire window
+ *  \par Function Description
+ *  Drops all cached page tiles and schedules redraw of the
+ *  window.
+ *
+ *  \param [in,out] view The Gschem page view to redraw
+ */
+void
+gschem_page_view_invalidate_all (GschemPageView *view)
+{
+  /* this function can be called early during initialization */
+  if (view == NULL) {
     return;
   }
 
-  gdk_window_invalidate_rect (window, NULL, FALSE);
+  tile_cache_flush (view);
+  damage_clear (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 
@@ -719,6 +805,247 @@ gschem_page_view_invalidate_world_rect (GschemPageView *view, int left, int top,
 
 
 
+/*! \brief Drop cached tiles overlapping a world rectangle
+ *
+ *  \param [in,out] view   The Gschem page view
+ *  \param [in]     bounds The rectangle in world coordinates
+ */
+static void
+drop_tiles (GschemPageView *view, const LeptonBounds *bounds)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  if (view->_tile_cache == NULL) {
+    return;
+  }
+
+  g_hash_table_iter_init (&iter, view->_tile_cache);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    PageViewTile *tile = (PageViewTile*) key;
+
+    if (tile_intersects_world_rect (tile,
+                                    bounds->min_x,
+                                    bounds->min_y,
+                                    bounds->max_x,
+                                    bounds->max_y)) {
+      g_queue_delete_link (view->_tile_lru, tile->lru_link);
+      g_hash_table_iter_remove (&iter);
+    }
+  }
+}
+
+
+
+/*! \brief Get the area added by merging two rectangles
+ *  \par Function Description
+ *  Returns the area of the union of the two rectangles that is
+ *  covered by neither of them, or a negative value if they
+ *  overlap.
+ */
+static double
+damage_merge_cost (const LeptonBounds *a, const LeptonBounds *b)
+{
+  LeptonBounds u;
+
+  if (a->min_x <= b->max_x && b->min_x <= a->max_x &&
+      a->min_y <= b->max_y && b->min_y <= a->max_y) {
+    return -1;
+  }
+
+  lepton_bounds_union (&u, a, b);
+
+#define AREA(r) ((double) ((r)->max_x - (r)->min_x) * ((r)->max_y - (r)->min_y))
+  return AREA (&u) - AREA (a) - AREA (b);
+#undef AREA
+}
+
+
+
+/*! \brief Coalesce damaged rectangles
+ *  \par Function Description
+ *  Merges overlapping damaged rectangles, as well as those whose
+ *  union is not larger than they are, and then merges the
+ *  cheapest pairs until at most #DAMAGE_MAX_RECTS rectangles are
+ *  left.  Too many rectangles are just replaced by their extents.
+ *
+ *  \param [in,out] damage The array of LeptonBounds to coalesce
+ */
+static void
+damage_coalesce (GArray *damage)
+{
+  guint i, j;
+  gboolean merged;
+
+  if (damage->len > DAMAGE_COALESCE_LIMIT) {
+    LeptonBounds extents = g_array_index (damage, LeptonBounds, 0);
+
+    for (i = 1; i < damage->len; i++) {
+      lepton_bounds_union (&extents,
+                           &extents,
+                           &g_array_index (damage, LeptonBounds, i));
+    }
+    g_array_set_size (damage, 1);
+    g_array_index (damage, LeptonBounds, 0) = extents;
+    return;
+  }
+
+  do {
+    merged = FALSE;
+    for (i = 0; i < damage->len; i++) {
+      LeptonBounds *a = &g_array_index (damage, LeptonBounds, i);
+
+      for (j = i + 1; j < damage->len; ) {
+        LeptonBounds *b = &g_array_index (damage, LeptonBounds, j);
+
+        if (damage_merge_cost (a, b) <= 0) {
+          lepton_bounds_union (a, a, b);
+          g_array_remove_index_fast (damage, j);
+          merged = TRUE;
+        } else {
+          j++;
+        }
+      }
+    }
+  } while (merged);
+
+  while (damage->len > DAMAGE_MAX_RECTS) {
+    guint best_i = 0, best_j = 1;
+    double best_cost = G_MAXDOUBLE;
+
+    for (i = 0; i < damage->len; i++) {
+      for (j = i + 1; j < damage->len; j++) {
+        double cost = damage_merge_cost (&g_array_index (damage, LeptonBounds, i),
+                                         &g_array_index (damage, LeptonBounds, j));
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+
+    lepton_bounds_union (&g_array_index (damage, LeptonBounds, best_i),
+                         &g_array_index (damage, LeptonBounds, best_i),
+                         &g_array_index (damage, LeptonBounds, best_j));
+    g_array_remove_index_fast (damage, best_j);
+  }
+}
+
+
+
+/*! \brief Forget pending damage
+ *
+ *  \param [in,out] view The Gschem page view
+ */
+static void
+damage_clear (GschemPageView *view)
+{
+  if (view->_damage_source != 0) {
+    g_source_remove (view->_damage_source);
+    view->_damage_source = 0;
+  }
+
+  if (view->_damage != NULL) {
+    g_array_set_size (view->_damage, 0);
+  }
+}
+
+
+
+/*! \brief Redraw pending damage
+ *  \par Function Description
+ *  Coalesces the damaged rectangles accumulated since the last
+ *  flush, drops cached tiles overlapping them, and schedules
+ *  their redraw.
+ *
+ *  \param [in,out] view The Gschem page view
+ */
+static void
+damage_flush (GschemPageView *view)
+{
+  guint i;
+
+  if (view->_damage_source != 0) {
+    g_source_remove (view->_damage_source);
+    view->_damage_source = 0;
+  }
+
+  if (view->_damage->len == 0) {
+    return;
+  }
+
+  damage_coalesce (view->_damage);
+
+  for (i = 0; i < view->_damage->len; i++) {
+    LeptonBounds *bounds = &g_array_index (view->_damage, LeptonBounds, i);
+
+    drop_tiles (view, bounds);
+    gschem_page_view_invalidate_world_rect (view,
+                                            bounds->min_x,
+                                            bounds->min_y,
+                                            bounds->max_x,
+                                            bounds->max_y);
+  }
+
+  g_array_set_size (view->_damage, 0);
+}
+
+
+
+static gboolean
+damage_flush_idle (gpointer user_data)
+{
+  GschemPageView *view = GSCHEM_PAGE_VIEW (user_data);
+
+  view->_damage_source = 0;
+  damage_flush (view);
+
+  return FALSE;
+}
+
+
+
+/*! \brief Schedule redraw of the given changed rectangle
+ *  \par Function Description
+ *  Adds the given rectangle to the damaged region of the view.
+ *  Unlike gschem_page_view_invalidate_world_rect(), which is used
+ *  for things drawn over the page like rubber band objects, this
+ *  function must be called when the page contents or the
+ *  selection state of objects change.
+ *
+ *  Damage is accumulated until the main loop is about to redraw
+ *  the view.  Then it is coalesced into a few rectangles, cached
+ *  tiles overlapping them are dropped, and only these rectangles
+ *  are redrawn.
+ *
+ *  \param [in,out] view   The Gschem page view to redraw
+ *  \param [in]     left
+ *  \param [in]     top
+ *  \param [in]     right
+ *  \param [in]     bottom
+ */
+void
+gschem_page_view_damage_world_rect (GschemPageView *view, int left, int top, int right, int bottom)
+{
+  LeptonBounds bounds;
+
+  g_return_if_fail (view != NULL);
+
+  lepton_bounds_init_with_points (&bounds, left, top, right, bottom);
+  g_array_append_val (view->_damage, bounds);
+
+  if (view->_damage_source == 0) {
+    view->_damage_source = g_idle_add_full (DAMAGE_PRIORITY,
+                                            damage_flush_idle,
+                                            view,
+                                            NULL);
+  }
+}
+
+
+
 /*! \brief Initialize GschemPageView instance
  *
  *  \param [in,out] view the gschem page view
@@ -737,6 +1064,10 @@ gschem_page_view_init (GschemPageView *view)
 #endif
 
   geometry_cache_create (view);
+  tile_cache_create (view);
+
+  view->_damage = g_array_new (FALSE, FALSE, sizeof (LeptonBounds));
+  view->_damage_source = 0;
 
   view->_page = NULL;
   view->configured = FALSE;
@@ -763,6 +1094,11 @@ gschem_page_view_init (GschemPageView *view)
                    G_CALLBACK (event_unrealize),
                    NULL);
 
+  g_signal_connect (view,
+                    "map",
+                    G_CALLBACK (event_map),
+                    NULL);
+
   g_signal_connect (view,
                    "toggle-hidden-text",
                    G_CALLBACK (event_toggle_hidden_text),
@@ -819,7 +1155,7 @@ gschem_page_view_pan_general (GschemPageView *view, int w_x, int w_y, double rel
 
   g_signal_emit_by_name (view, "update-grid-info");
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 
@@ -838,7 +1174,7 @@ gschem_page_view_pan (GschemPageView *view, int w_x, int w_y)
   x_event_faked_motion (view, NULL);
 
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 
@@ -950,7 +1286,7 @@ gboolean
 gschem_page_view_pan_end (GschemPageView *view)
 {
   if (view->doing_pan) {
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
     view->doing_pan = FALSE;
     return TRUE;
   } else {
@@ -1170,7 +1506,7 @@ hadjustment_value_changed (GtkAdjustment *hadjustment, GschemPageView *view)
     geometry->viewport_left = new_left;
     geometry->viewport_right = geometry->viewport_right - (current_left - new_left);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
   }
 }
 
@@ -1443,7 +1779,7 @@ vadjustment_value_changed (GtkAdjustment *vadjustment, GschemPageView *view)
     geometry->viewport_bottom = new_bottom;
     geometry->viewport_top = geometry->viewport_top - (current_bottom - new_bottom);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
   }
 }
 
@@ -1498,7 +1834,7 @@ gschem_page_view_zoom_extents (GschemPageView *view, const GList *objects)
 
   g_signal_emit_by_name (view, "update-grid-info");
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 /*! \brief Zoom in on a single object
@@ -1560,7 +1896,7 @@ gschem_page_view_zoom_object (GschemPageView *view, LeptonObject *object)
                                      viewport_center_x + viewport_width / 2,
                                      viewport_center_y + viewport_height / 2);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
   }
 }
 
@@ -1590,6 +1926,9 @@ gschem_page_view_redraw (GschemPageView *view,
 
   page = gschem_page_view_get_page (view);
 
+  /* Cached tiles of changed objects must not be painted. */
+  damage_flush (view);
+
   if (page != NULL) {
     geometry = gschem_page_view_get_page_geometry (view);
 
@@ -1597,13 +1936,13 @@ gschem_page_view_redraw (GschemPageView *view,
 
 #ifdef ENABLE_GTK3
     o_redraw_rect (w_current,
-                   GTK_WIDGET(view),
+                   view,
                    page,
                    geometry,
                    cr);
 #else
     o_redraw_rect (w_current,
-                   gtk_widget_get_window (GTK_WIDGET(view)),
+                   view,
                    page,
                    geometry,
                    &(event->area));
@@ -1691,3 +2030,235 @@ geometry_cache_finalize (GschemPageView *view)
   g_hash_table_destroy (view->_geometry_cache);
   view->_geometry_cache = NULL;
 }
+
+
+
+/*! \brief Get the hash of a page tile by its position and scale
+ */
+static guint
+tile_hash (gconstpointer key)
+{
+  const PageViewTile *tile = (const PageViewTile*) key;
+
+  return ((guint) tile->column * 7919u)
+    ^ ((guint) tile->row * 104729u)
+    ^ g_double_hash (&(tile->scale_x));
+}
+
+static gboolean
+tile_equal (gconstpointer a, gconstpointer b)
+{
+  const PageViewTile *tile_a = (const PageViewTile*) a;
+  const PageViewTile *tile_b = (const PageViewTile*) b;
+
+  return (tile_a->column == tile_b->column)
+    && (tile_a->row == tile_b->row)
+    && (tile_a->scale_x == tile_b->scale_x)
+    && (tile_a->scale_y == tile_b->scale_y);
+}
+
+static void
+tile_free (PageViewTile *tile)
+{
+  cairo_surface_destroy (tile->surface);
+  g_free (tile);
+}
+
+/*! \brief Test if objects within a world rectangle may be drawn on a tile
+ *  \par Function Description
+ *  Cues and grips have a fixed size on screen and may be drawn
+ *  outside of the object bounds, so the rectangle is bloated
+ *  accordingly at the scale of the tile.
+ */
+static gboolean
+tile_intersects_world_rect (const PageViewTile *tile,
+                            int min_x,
+                            int min_y,
+                            int max_x,
+                            int max_y)
+{
+  double size = GSCHEM_PAGE_VIEW_TILE_SIZE;
+  double bloat = MAX (GRIP_SIZE / 2, CUE_BOX_SIZE * tile->scale_x)
+    + INVALIDATE_MARGIN;
+
+  /* The y axis is flipped in page pixel coordinates */
+  double x1 = min_x * tile->scale_x - bloat;
+  double x2 = max_x * tile->scale_x + bloat;
+  double y1 = - max_y * tile->scale_y - bloat;
+  double y2 = - min_y * tile->scale_y + bloat;
+
+  return (x2 >= tile->column * size)
+    && (x1 < (tile->column + 1) * size)
+    && (y2 >= tile->row * size)
+    && (y1 < (tile->row + 1) * size);
+}
+
+static void
+tile_cache_create (GschemPageView *view)
+{
+  g_return_if_fail (view && !view->_tile_cache);
+
+  view->_tile_cache =
+    g_hash_table_new_full (tile_hash,
+                           tile_equal,
+                           NULL, /* key_destroy_func */
+                           (GDestroyNotify) tile_free);
+  view->_tile_lru = g_queue_new ();
+  view->_tile_flags = 0;
+}
+
+static void
+tile_cache_remove (GschemPageView *view, PageViewTile *tile)
+{
+  g_queue_delete_link (view->_tile_lru, tile->lru_link);
+  g_hash_table_remove (view->_tile_cache, tile);
+}
+
+static void
+tile_cache_flush (GschemPageView *view)
+{
+  g_return_if_fail (view);
+  if (!view->_tile_cache)
+    return;
+
+  g_queue_clear (view->_tile_lru);
+  g_hash_table_remove_all (view->_tile_cache);
+}
+
+static void
+tile_cache_finalize (GschemPageView *view)
+{
+  g_return_if_fail (view);
+  if (!view->_tile_cache)
+    return;
+
+  tile_cache_flush (view);
+  g_hash_table_destroy (view->_tile_cache);
+  g_queue_free (view->_tile_lru);
+  view->_tile_cache = NULL;
+  view->_tile_lru = NULL;
+}
+
+
+
+/*! \brief Look up a cached tile of the page layer
+ *  \par Function Description
+ *  Returns the tile at the given column and row for the current
+ *  scale of the view if it has been rendered with the given
+ *  render \a flags and has not been damaged since then.  The tile
+ *  covers the page pixels from (column * GSCHEM_PAGE_VIEW_TILE_SIZE,
+ *  row * GSCHEM_PAGE_VIEW_TILE_SIZE) to the next column and row.
+ *
+ *  \param [in] view   The GschemPageView
+ *  \param [in] column The tile column
+ *  \param [in] row    The tile row
+ *  \param [in] flags  The EdaRenderer flags the tile is rendered with
+ *  \return The tile surface owned by the view, or NULL.
+ */
+cairo_surface_t*
+gschem_page_view_lookup_tile (GschemPageView *view,
+                              int column,
+                              int row,
+                              int flags)
+{
+  GschemPageGeometry *geometry;
+  PageViewTile key;
+  PageViewTile *tile;
+
+  g_return_val_if_fail (view != NULL, NULL);
+
+  geometry = gschem_page_view_get_page_geometry (view);
+
+  if ((geometry == NULL)
+      || (view->_tile_cache == NULL)
+      || (flags != view->_tile_flags)) {
+    return NULL;
+  }
+
+  key.scale_x = geometry->to_screen_x_constant;
+  key.scale_y = geometry->to_screen_y_constant;
+  key.column = column;
+  key.row = row;
+
+  tile = (PageViewTile*) g_hash_table_lookup (view->_tile_cache, &key);
+
+  if (tile == NULL) {
+    return NULL;
+  }
+
+  /* Move the tile to the head of the LRU queue */
+  g_queue_unlink (view->_tile_lru, tile->lru_link);
+  g_queue_push_head_link (view->_tile_lru, tile->lru_link);
+
+  return tile->surface;
+}
+
+
+
+/*! \brief Add a tile of the page layer to the cache
+ *  \par Function Description
+ *  Stores \a surface as the tile at the given column and row for
+ *  the current scale of the view.  If the render \a flags differ
+ *  from the flags of the cached tiles, the cache is emptied first.
+ *  The least recently used tiles are dropped when the cache grows
+ *  larger than needed to cover the view twice.
+ *
+ *  \param [in] view    The GschemPageView
+ *  \param [in] column  The tile column
+ *  \param [in] row     The tile row
+ *  \param [in] flags   The EdaRenderer flags the tile is rendered with
+ *  \param [in] surface The tile surface, a reference is taken
+ */
+void
+gschem_page_view_insert_tile (GschemPageView *view,
+                              int column,
+                              int row,
+                              int flags,
+                              cairo_surface_t *surface)
+{
+  GschemPageGeometry *geometry;
+  PageViewTile *tile;
+  PageViewTile *old_tile;
+  guint max_tiles;
+
+  g_return_if_fail (view != NULL);
+  g_return_if_fail (surface != NULL);
+
+  geometry = gschem_page_view_get_page_geometry (view);
+
+  if ((geometry == NULL) || (view->_tile_cache == NULL)) {
+    return;
+  }
+
+  if (flags != view->_tile_flags) {
+    tile_cache_flush (view);
+    view->_tile_flags = flags;
+  }
+
+  tile = g_new0 (PageViewTile, 1);
+  tile->scale_x = geometry->to_screen_x_constant;
+  tile->scale_y = geometry->to_screen_y_constant;
+  tile->column = column;
+  tile->row = row;
+  tile->surface = cairo_surface_reference (surface);
+
+  old_tile = (PageViewTile*) g_hash_table_lookup (view->_tile_cache, tile);
+
+  if (old_tile != NULL) {
+    tile_cache_remove (view, old_tile);
+  }
+
+  g_queue_push_head (view->_tile_lru, tile);
+  tile->lru_link = g_queue_peek_head_link (view->_tile_lru);
+  g_hash_table_add (view->_tile_cache, tile);
+
+  max_tiles =
+    MAX (TILE_CACHE_MIN_SIZE,
+         2 * (geometry->screen_width / GSCHEM_PAGE_VIEW_TILE_SIZE + 2)
+         * (geometry->screen_height / GSCHEM_PAGE_VIEW_TILE_SIZE + 2));
+
+  while (g_queue_get_length (view->_tile_lru) > max_tiles) {
+    tile_cache_remove (view,
+                       (PageViewTile*) g_queue_peek_tail (view->_tile_lru));
+  }
+}
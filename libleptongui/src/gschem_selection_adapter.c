@@ -51,6 +51,58 @@ enum
   PROP_TEXT_STRING
 };
 
+/*! \private
+ *  \brief Properties aggregated over the selected objects
+ */
+enum
+{
+  AGGREGATE_CAP_STYLE,
+  AGGREGATE_DASH_LENGTH,
+  AGGREGATE_DASH_SPACE,
+  AGGREGATE_FILL_ANGLE1,
+  AGGREGATE_FILL_ANGLE2,
+  AGGREGATE_FILL_PITCH1,
+  AGGREGATE_FILL_PITCH2,
+  AGGREGATE_FILL_TYPE,
+  AGGREGATE_FILL_WIDTH,
+  AGGREGATE_LINE_TYPE,
+  AGGREGATE_LINE_WIDTH,
+  AGGREGATE_OBJECT_COLOR,
+  AGGREGATE_PIN_TYPE,
+  AGGREGATE_TEXT_ALIGNMENT,
+  AGGREGATE_TEXT_COLOR,
+  AGGREGATE_TEXT_ROTATION,
+  AGGREGATE_TEXT_SIZE,
+  AGGREGATE_COUNT
+};
+
+/*! \private
+ *  \brief Property values of a selected object
+ *
+ *  Bit N of \a mask is set if the object has the property N.
+ *  The values are kept to be subtracted from the aggregates when
+ *  the object is deselected or changed.
+ */
+typedef struct
+{
+  guint mask;
+  gint values[AGGREGATE_COUNT];
+} SelectionEntry;
+
+/*! \private
+ *  \brief Running aggregates of the selection
+ *
+ *  For every property, \a values maps each distinct value in the
+ *  selection to the number of selected objects having it, so the
+ *  property value is known from the size of the table alone.
+ */
+struct st_selection_aggregates
+{
+  GHashTable *entries;  /* LeptonObject* -> SelectionEntry* */
+  GHashTable *texts;    /* selected text objects */
+  GHashTable *values[AGGREGATE_COUNT];
+};
+
 
 
 G_DEFINE_TYPE (GschemSelectionAdapter,
@@ -58,11 +110,20 @@ G_DEFINE_TYPE (GschemSelectionAdapter,
                G_TYPE_OBJECT);
 
 
+static gint
+aggregate_get (GschemSelectionAdapter *adapter, gint index);
+
 static void
-gschem_selection_adapter_class_init (GschemSelectionAdapterClass *klass);
+dispose (GObject *object);
+
+static void
+entry_set (SelectionEntry *entry, gint index, gint value);
 
-static GList*
-get_selection_iter (GschemSelectionAdapter *adapter);
+static void
+finalize (GObject *object);
+
+static void
+gschem_selection_adapter_class_init (GschemSelectionAdapterClass *klass);
 
 static void
 get_property (GObject *object, guint param_id, GValue *value, GParamSpec *pspec);
@@ -70,12 +131,32 @@ get_property (GObject *object, guint param_id, GValue *value, GParamSpec *pspec)
 static void
 gschem_selection_adapter_init (GschemSelectionAdapter *adapter);
 
+static int
+object_changed (void *user_data, LeptonObject *object);
+
 static void
 selection_changed (LeptonList *selection,
                    GschemSelectionAdapter *adapter);
 static void
+selection_item_added (LeptonList *selection,
+                      gpointer item,
+                      GschemSelectionAdapter *adapter);
+static void
+selection_item_removed (LeptonList *selection,
+                        gpointer item,
+                        GschemSelectionAdapter *adapter);
+static void
 set_property (GObject *object, guint param_id, const GValue *value, GParamSpec *pspec);
 
+static void
+track_object (GschemSelectionAdapter *adapter, LeptonObject *object);
+
+static void
+untrack_object (GschemSelectionAdapter *adapter, LeptonObject *object);
+
+static void
+update_aggregates (GschemSelectionAdapter *adapter);
+
 
 
 /*! \brief Get the cap style from the selection
@@ -89,39 +170,7 @@ set_property (GObject *object, guint param_id, const GValue *value, GParamSpec *
 int
 gschem_selection_adapter_get_cap_style (GschemSelectionAdapter *adapter)
 {
-  gint cap_style = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    LeptonStrokeCapType temp_cap_style;
-    gint temp_dash_length;
-    gint temp_dash_space;
-    LeptonStrokeType temp_line_type;
-    gint temp_line_width;
-
-    success = lepton_object_get_line_options (object,
-                                              &temp_cap_style,
-                                              &temp_line_type,
-                                              &temp_line_width,
-                                              &temp_dash_length,
-                                              &temp_dash_space);
-
-    if (success) {
-      if (cap_style < 0) {
-        cap_style = temp_cap_style;
-      }
-      else if (cap_style != temp_cap_style) {
-        cap_style = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return cap_style;
+  return aggregate_get (adapter, AGGREGATE_CAP_STYLE);
 }
 
 
@@ -137,39 +186,7 @@ gschem_selection_adapter_get_cap_style (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_dash_length (GschemSelectionAdapter *adapter)
 {
-  gint dash_length = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    LeptonStrokeCapType temp_cap_style;
-    gint temp_dash_length;
-    gint temp_dash_space;
-    LeptonStrokeType temp_line_type;
-    gint temp_line_width;
-
-    success = lepton_object_get_line_options (object,
-                                              &temp_cap_style,
-                                              &temp_line_type,
-                                              &temp_line_width,
-                                              &temp_dash_length,
-                                              &temp_dash_space);
-
-    if (success) {
-      if (dash_length < 0) {
-        dash_length = temp_dash_length;
-      }
-      else if (dash_length != temp_dash_length) {
-        dash_length = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return dash_length;
+  return aggregate_get (adapter, AGGREGATE_DASH_LENGTH);
 }
 
 
@@ -185,39 +202,7 @@ gschem_selection_adapter_get_dash_length (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_dash_space (GschemSelectionAdapter *adapter)
 {
-  gint dash_space = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    LeptonStrokeCapType temp_cap_style;
-    gint temp_dash_length;
-    gint temp_dash_space;
-    LeptonStrokeType temp_line_type;
-    gint temp_line_width;
-
-    success = lepton_object_get_line_options (object,
-                                              &temp_cap_style,
-                                              &temp_line_type,
-                                              &temp_line_width,
-                                              &temp_dash_length,
-                                              &temp_dash_space);
-
-    if (success) {
-      if (dash_space < 0) {
-        dash_space = temp_dash_space;
-      }
-      else if (dash_space != temp_dash_space) {
-        dash_space = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return dash_space;
+  return aggregate_get (adapter, AGGREGATE_DASH_SPACE);
 }
 
 
@@ -233,42 +218,7 @@ gschem_selection_adapter_get_dash_space (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_angle1 (GschemSelectionAdapter *adapter)
 {
-  gint fill_angle = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_angle < 0) {
-        fill_angle = temp_angle1;
-      }
-      else if (fill_angle != temp_angle1) {
-        fill_angle = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_angle;
+  return aggregate_get (adapter, AGGREGATE_FILL_ANGLE1);
 }
 
 
@@ -284,42 +234,7 @@ gschem_selection_adapter_get_fill_angle1 (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_angle2 (GschemSelectionAdapter *adapter)
 {
-  gint fill_angle = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_angle < 0) {
-        fill_angle = temp_angle2;
-      }
-      else if (fill_angle != temp_angle2) {
-        fill_angle = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_angle;
+  return aggregate_get (adapter, AGGREGATE_FILL_ANGLE2);
 }
 
 
@@ -335,42 +250,7 @@ gschem_selection_adapter_get_fill_angle2 (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_pitch1 (GschemSelectionAdapter *adapter)
 {
-  gint fill_pitch = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_pitch < 0) {
-        fill_pitch = temp_pitch1;
-      }
-      else if (fill_pitch != temp_pitch1) {
-        fill_pitch = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_pitch;
+  return aggregate_get (adapter, AGGREGATE_FILL_PITCH1);
 }
 
 
@@ -386,42 +266,7 @@ gschem_selection_adapter_get_fill_pitch1 (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_pitch2 (GschemSelectionAdapter *adapter)
 {
-  gint fill_pitch = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_pitch < 0) {
-        fill_pitch = temp_pitch2;
-      }
-      else if (fill_pitch != temp_pitch2) {
-        fill_pitch = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_pitch;
+  return aggregate_get (adapter, AGGREGATE_FILL_PITCH2);
 }
 
 
@@ -437,42 +282,7 @@ gschem_selection_adapter_get_fill_pitch2 (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_type (GschemSelectionAdapter *adapter)
 {
-  gint fill_type = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_type < 0) {
-        fill_type = temp_fill_type;
-      }
-      else if (fill_type != temp_fill_type) {
-        fill_type = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_type;
+  return aggregate_get (adapter, AGGREGATE_FILL_TYPE);
 }
 
 
@@ -488,42 +298,7 @@ gschem_selection_adapter_get_fill_type (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_fill_width (GschemSelectionAdapter *adapter)
 {
-  gint fill_width = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    gint temp_angle1;
-    gint temp_angle2;
-    LeptonFillType temp_fill_type;
-    gint temp_pitch1;
-    gint temp_pitch2;
-    gint temp_width;
-
-    success = lepton_object_get_fill_options (object,
-                                              &temp_fill_type,
-                                              &temp_width,
-                                              &temp_pitch1,
-                                              &temp_angle1,
-                                              &temp_pitch2,
-                                              &temp_angle2);
-
-
-    if (success) {
-      if (fill_width < 0) {
-        fill_width = temp_width;
-      }
-      else if (fill_width != temp_width) {
-        fill_width = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return fill_width;
+  return aggregate_get (adapter, AGGREGATE_FILL_WIDTH);
 }
 
 
@@ -539,39 +314,7 @@ gschem_selection_adapter_get_fill_width (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_line_type (GschemSelectionAdapter *adapter)
 {
-  gint line_type = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    LeptonStrokeCapType temp_cap_style;
-    gint temp_dash_length;
-    gint temp_dash_space;
-    LeptonStrokeType temp_line_type;
-    gint temp_line_width;
-
-    success = lepton_object_get_line_options (object,
-                                              &temp_cap_style,
-                                              &temp_line_type,
-                                              &temp_line_width,
-                                              &temp_dash_length,
-                                              &temp_dash_space);
-
-    if (success) {
-      if (line_type < 0) {
-        line_type = temp_line_type;
-      }
-      else if (line_type != temp_line_type) {
-        line_type = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return line_type;
+  return aggregate_get (adapter, AGGREGATE_LINE_TYPE);
 }
 
 
@@ -587,39 +330,7 @@ gschem_selection_adapter_get_line_type (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_line_width (GschemSelectionAdapter *adapter)
 {
-  gint line_width = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-    gboolean success;
-    LeptonStrokeCapType temp_cap_style;
-    gint temp_dash_length;
-    gint temp_dash_space;
-    LeptonStrokeType temp_line_type;
-    gint temp_line_width;
-
-    success = lepton_object_get_line_options (object,
-                                              &temp_cap_style,
-                                              &temp_line_type,
-                                              &temp_line_width,
-                                              &temp_dash_length,
-                                              &temp_dash_space);
-
-    if (success) {
-      if (line_width < 0) {
-        line_width = temp_line_width;
-      }
-      else if (line_width != temp_line_width) {
-        line_width = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return line_width;
+  return aggregate_get (adapter, AGGREGATE_LINE_WIDTH);
 }
 
 
@@ -635,48 +346,7 @@ gschem_selection_adapter_get_line_width (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_object_color (GschemSelectionAdapter *adapter)
 {
-  int color = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    iter = g_list_next (iter);
-    if ((object != NULL) &&
-        (lepton_object_is_arc (object)  ||
-         lepton_object_is_box (object)  ||
-         lepton_object_is_bus (object)  ||
-         lepton_object_is_net (object)  ||
-         lepton_object_is_line (object) ||
-         lepton_object_is_path (object) ||
-         lepton_object_is_text (object) ||
-         lepton_object_is_circle (object)))
-    {
-      color = lepton_object_get_color (object);
-      break;
-    }
-  }
-
-  /* Check if all other objects have the same properties */
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    if ((object != NULL) &&
-        (lepton_object_is_arc (object)  ||
-         lepton_object_is_box (object)  ||
-         lepton_object_is_line (object) ||
-         lepton_object_is_path (object) ||
-         lepton_object_is_text (object) ||
-         lepton_object_is_circle (object)))
-    {
-      if (color != lepton_object_get_color (object)) {
-        color = MULTIPLE_VALUES;
-        break;
-      }
-    }
-    iter = g_list_next (iter);
-  }
-
-  return color;
+  return aggregate_get (adapter, AGGREGATE_OBJECT_COLOR);
 }
 
 
@@ -692,34 +362,7 @@ gschem_selection_adapter_get_object_color (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_pin_type (GschemSelectionAdapter *adapter)
 {
-  int type = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    iter = g_list_next (iter);
-    if (lepton_object_is_pin (object))
-    {
-      type = object->pin_type;
-      break;
-    }
-  }
-
-  /* Check if all other objects have the same properties */
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    if (lepton_object_is_pin (object))
-    {
-      if (type != object->pin_type) {
-        type = MULTIPLE_VALUES;
-        break;
-      }
-    }
-    iter = g_list_next (iter);
-  }
-
-  return type;
+  return aggregate_get (adapter, AGGREGATE_PIN_TYPE);
 }
 
 
@@ -750,29 +393,7 @@ gschem_selection_adapter_get_selection (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_text_alignment (GschemSelectionAdapter *adapter)
 {
-  gint alignment = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-
-    if (lepton_object_is_text (object))
-    {
-      int temp_alignment = lepton_text_object_get_alignment (object);
-
-      if (alignment < 0) {
-        alignment = temp_alignment;
-      }
-      else if (alignment != temp_alignment) {
-        alignment = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return alignment;
+  return aggregate_get (adapter, AGGREGATE_TEXT_ALIGNMENT);
 }
 
 
@@ -781,41 +402,14 @@ gschem_selection_adapter_get_text_alignment (GschemSelectionAdapter *adapter)
  *
  *  \param [in] adapter This adapter
  *
- *  \retval NO_SELECTION    No objects are selected
- *  \retval MULTIPLE_VALUES Multiple objects with different colors are selected
- *  \retval others          The color of the selected objects
- */
-int
-gschem_selection_adapter_get_text_color (GschemSelectionAdapter *adapter)
-{
-  int color = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    iter = g_list_next (iter);
-    if (lepton_object_is_text (object))
-    {
-      color = lepton_object_get_color (object);
-      break;
-    }
-  }
-
-  /* Check if all other objects have the same properties */
-
-  while (iter != NULL) {
-    LeptonObject* object = (LeptonObject *) iter->data;
-    if (lepton_object_is_text (object))
-    {
-      if (color != lepton_object_get_color (object)) {
-        color = MULTIPLE_VALUES;
-        break;
-      }
-    }
-    iter = g_list_next (iter);
-  }
-
-  return color;
+ *  \retval NO_SELECTION    No objects are selected
+ *  \retval MULTIPLE_VALUES Multiple objects with different colors are selected
+ *  \retval others          The color of the selected objects
+ */
+int
+gschem_selection_adapter_get_text_color (GschemSelectionAdapter *adapter)
+{
+  return aggregate_get (adapter, AGGREGATE_TEXT_COLOR);
 }
 
 
@@ -831,29 +425,7 @@ gschem_selection_adapter_get_text_color (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_text_rotation (GschemSelectionAdapter *adapter)
 {
-  gint angle = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-
-    if (lepton_object_is_text (object))
-    {
-      int temp_angle = lepton_text_object_get_angle (object);
-
-      if (angle < 0) {
-        angle = temp_angle;
-      }
-      else if (angle != temp_angle) {
-        angle = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return angle;
+  return aggregate_get (adapter, AGGREGATE_TEXT_ROTATION);
 }
 
 
@@ -869,29 +441,7 @@ gschem_selection_adapter_get_text_rotation (GschemSelectionAdapter *adapter)
 int
 gschem_selection_adapter_get_text_size (GschemSelectionAdapter *adapter)
 {
-  gint size = NO_SELECTION;
-  GList *iter = get_selection_iter (adapter);
-
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
-
-    if (lepton_object_is_text (object))
-    {
-      int temp_size = lepton_text_object_get_size (object);
-
-      if (size < 0) {
-        size = temp_size;
-      }
-      else if (size != temp_size) {
-        size = MULTIPLE_VALUES;
-        break;
-      }
-    }
-
-    iter = g_list_next (iter);
-  }
-
-  return size;
+  return aggregate_get (adapter, AGGREGATE_TEXT_SIZE);
 }
 
 
@@ -905,26 +455,22 @@ gschem_selection_adapter_get_text_size (GschemSelectionAdapter *adapter)
 const char*
 gschem_selection_adapter_get_text_string (GschemSelectionAdapter *adapter)
 {
-  const char *string = NULL;
-  GList *iter = get_selection_iter (adapter);
+  GHashTable *texts;
+  GHashTableIter iter;
+  gpointer object;
 
-  while (iter != NULL) {
-    LeptonObject *object = (LeptonObject*) iter->data;
+  g_return_val_if_fail (adapter != NULL, NULL);
 
-    if (lepton_object_is_text (object))
-    {
-      if (string == NULL) {
-        string = lepton_text_object_get_string (object);
-      } else {
-        string = NULL;
-        break;
-      }
-    }
+  texts = adapter->aggregates->texts;
 
-    iter = g_list_next (iter);
+  if (g_hash_table_size (texts) != 1) {
+    return NULL;
   }
 
-  return string;
+  g_hash_table_iter_init (&iter, texts);
+  g_hash_table_iter_next (&iter, &object, NULL);
+
+  return lepton_text_object_get_string ((LeptonObject*) object);
 }
 
 
@@ -1010,6 +556,8 @@ gschem_selection_adapter_set_fill_angle1 (GschemSelectionAdapter *adapter, int a
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-angle1");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1069,6 +617,8 @@ gschem_selection_adapter_set_fill_angle2 (GschemSelectionAdapter *adapter, int a
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-angle2");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1130,6 +680,8 @@ gschem_selection_adapter_set_fill_pitch1 (GschemSelectionAdapter *adapter, int p
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-pitch1");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1189,6 +741,8 @@ gschem_selection_adapter_set_fill_pitch2 (GschemSelectionAdapter *adapter, int p
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-pitch2");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1250,6 +804,8 @@ gschem_selection_adapter_set_fill_type (GschemSelectionAdapter *adapter, int fil
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-angle1");
   g_object_notify (G_OBJECT (adapter), "fill-angle2");
   g_object_notify (G_OBJECT (adapter), "fill-pitch1");
@@ -1315,6 +871,8 @@ gschem_selection_adapter_set_fill_width (GschemSelectionAdapter *adapter, int fi
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "fill-width");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1372,6 +930,8 @@ gschem_selection_adapter_set_line_type (GschemSelectionAdapter *adapter, int lin
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "line-type");
   g_object_notify (G_OBJECT (adapter), "dash-length");
   g_object_notify (G_OBJECT (adapter), "dash-space");
@@ -1431,6 +991,8 @@ gschem_selection_adapter_set_line_width (GschemSelectionAdapter *adapter, int li
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "line-width");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1488,6 +1050,8 @@ gschem_selection_adapter_set_dash_length (GschemSelectionAdapter *adapter, int d
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "dash-length");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1545,6 +1109,8 @@ gschem_selection_adapter_set_dash_space (GschemSelectionAdapter *adapter, int da
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "dash-space");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1602,6 +1168,8 @@ gschem_selection_adapter_set_cap_style (GschemSelectionAdapter *adapter, int cap
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "cap-style");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1623,6 +1191,8 @@ gschem_selection_adapter_set_object_color (GschemSelectionAdapter *adapter, int
   lepton_object_list_set_color (lepton_list_get_glist (adapter->selection),
                                 color);
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "object-color");
   g_object_notify (G_OBJECT (adapter), "text-color");
 
@@ -1659,6 +1229,8 @@ gschem_selection_adapter_set_pin_type (GschemSelectionAdapter *adapter, int type
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "pin-type");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1681,6 +1253,12 @@ gschem_selection_adapter_set_selection (GschemSelectionAdapter *adapter,
     g_signal_handlers_disconnect_by_func (adapter->selection,
                                           (gpointer) selection_changed,
                                           adapter);
+    g_signal_handlers_disconnect_by_func (adapter->selection,
+                                          (gpointer) selection_item_added,
+                                          adapter);
+    g_signal_handlers_disconnect_by_func (adapter->selection,
+                                          (gpointer) selection_item_removed,
+                                          adapter);
 
     g_object_unref (adapter->selection);
   }
@@ -1694,8 +1272,18 @@ gschem_selection_adapter_set_selection (GschemSelectionAdapter *adapter,
                       "changed",
                       G_CALLBACK (selection_changed),
                       adapter);
+    g_signal_connect (adapter->selection,
+                      "item-added",
+                      G_CALLBACK (selection_item_added),
+                      adapter);
+    g_signal_connect (adapter->selection,
+                      "item-removed",
+                      G_CALLBACK (selection_item_removed),
+                      adapter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "cap-style");
   g_object_notify (G_OBJECT (adapter), "dash-length");
   g_object_notify (G_OBJECT (adapter), "dash-space");
@@ -1741,6 +1329,8 @@ gschem_selection_adapter_set_text_alignment (GschemSelectionAdapter *adapter, in
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "text-alignment");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1774,6 +1364,8 @@ gschem_selection_adapter_set_text_color (GschemSelectionAdapter *adapter, int co
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "object-color");
   g_object_notify (G_OBJECT (adapter), "text-color");
 
@@ -1810,6 +1402,8 @@ gschem_selection_adapter_set_text_rotation (GschemSelectionAdapter *adapter, int
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "text-rotation");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1845,6 +1439,8 @@ gschem_selection_adapter_set_text_size (GschemSelectionAdapter *adapter, int siz
     iter = g_list_next (iter);
   }
 
+  update_aggregates (adapter);
+
   g_object_notify (G_OBJECT (adapter), "text-size");
 
   g_signal_emit_by_name (adapter, "handle-undo");
@@ -1909,7 +1505,114 @@ gschem_selection_adapter_set_toplevel (GschemSelectionAdapter *adapter,
 {
   g_return_if_fail (adapter != NULL);
 
+  if (adapter->toplevel != NULL) {
+    lepton_object_remove_change_notify (adapter->toplevel,
+                                        NULL,
+                                        object_changed,
+                                        adapter);
+  }
+
   adapter->toplevel = toplevel;
+
+  /* Keep the aggregates up to date when selected objects change */
+  if (adapter->toplevel != NULL) {
+    lepton_object_add_change_notify (adapter->toplevel,
+                                     NULL,
+                                     object_changed,
+                                     adapter);
+  }
+}
+
+
+
+/*! \private
+ *  \brief Get an aggregated property of the selection
+ *
+ *  \param [in] adapter This adapter
+ *  \param [in] index   The index of the property
+ *
+ *  \retval NO_SELECTION    No objects having the property are selected
+ *  \retval MULTIPLE_VALUES Selected objects have different values
+ *  \retval others          The value of the property
+ */
+static gint
+aggregate_get (GschemSelectionAdapter *adapter, gint index)
+{
+  GHashTable *values;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_val_if_fail (adapter != NULL, NO_SELECTION);
+
+  values = adapter->aggregates->values[index];
+
+  switch (g_hash_table_size (values)) {
+    case 0:
+      return NO_SELECTION;
+
+    case 1:
+      g_hash_table_iter_init (&iter, values);
+      g_hash_table_iter_next (&iter, &value, NULL);
+      return GPOINTER_TO_INT (value);
+
+    default:
+      return MULTIPLE_VALUES;
+  }
+}
+
+
+
+/*! \private
+ *  \brief Dispose of the object
+ */
+static void
+dispose (GObject *object)
+{
+  GschemSelectionAdapter *adapter = GSCHEM_SELECTION_ADAPTER (object);
+
+  gschem_selection_adapter_set_toplevel (adapter, NULL);
+  gschem_selection_adapter_set_selection (adapter, NULL);
+
+  G_OBJECT_CLASS (gschem_selection_adapter_parent_class)->dispose (object);
+}
+
+
+
+/*! \private
+ *  \brief Record a property value of an object
+ *
+ *  \param [in,out] entry The entry of the object
+ *  \param [in]     index The index of the property
+ *  \param [in]     value The value of the property
+ */
+static void
+entry_set (SelectionEntry *entry, gint index, gint value)
+{
+  entry->mask |= 1u << index;
+  entry->values[index] = value;
+}
+
+
+
+/*! \private
+ *  \brief Finalize object
+ */
+static void
+finalize (GObject *object)
+{
+  GschemSelectionAdapter *adapter = GSCHEM_SELECTION_ADAPTER (object);
+  gint index;
+
+  g_hash_table_destroy (adapter->aggregates->entries);
+  g_hash_table_destroy (adapter->aggregates->texts);
+
+  for (index = 0; index < AGGREGATE_COUNT; index++) {
+    g_hash_table_destroy (adapter->aggregates->values[index]);
+  }
+
+  g_free (adapter->aggregates);
+
+  G_OBJECT_CLASS (gschem_selection_adapter_parent_class)->finalize (object);
 }
 
 
@@ -1922,6 +1625,9 @@ gschem_selection_adapter_set_toplevel (GschemSelectionAdapter *adapter,
 static void
 gschem_selection_adapter_class_init (GschemSelectionAdapterClass *klass)
 {
+  G_OBJECT_CLASS (klass)->dispose = dispose;
+  G_OBJECT_CLASS (klass)->finalize = finalize;
+
   G_OBJECT_CLASS (klass)->get_property = get_property;
   G_OBJECT_CLASS (klass)->set_property = set_property;
 
@@ -2139,26 +1845,6 @@ gschem_selection_adapter_class_init (GschemSelectionAdapterClass *klass)
 }
 
 
-/*! \private
- *  \brief Get an iterator for objects in the selection
- *
- *  \param [in] adapter this adapter
- *  \return an iterator for the selection or NULL in none
- */
-static GList*
-get_selection_iter (GschemSelectionAdapter *adapter)
-{
-  GList *iter = NULL;
-  LeptonSelection *selection = gschem_selection_adapter_get_selection (adapter);
-
-  if (selection != NULL) {
-    iter = lepton_list_get_glist (selection);
-  }
-
-  return iter;
-}
-
-
 /*! \private
  *  \brief Get a property
  *
@@ -2259,6 +1945,49 @@ get_property (GObject *object, guint param_id, GValue *value, GParamSpec *pspec)
 static void
 gschem_selection_adapter_init (GschemSelectionAdapter *adapter)
 {
+  gint index;
+
+  adapter->aggregates = g_new0 (struct st_selection_aggregates, 1);
+
+  adapter->aggregates->entries = g_hash_table_new_full (g_direct_hash,
+                                                        g_direct_equal,
+                                                        NULL,
+                                                        g_free);
+
+  adapter->aggregates->texts = g_hash_table_new (g_direct_hash,
+                                                 g_direct_equal);
+
+  for (index = 0; index < AGGREGATE_COUNT; index++) {
+    adapter->aggregates->values[index] = g_hash_table_new (g_direct_hash,
+                                                           g_direct_equal);
+  }
+}
+
+
+
+/*! \private
+ *  \brief Change notification handler for objects
+ *
+ *  \par Function Description
+ *  This function gets called after any object is changed.  If the
+ *  object is selected, its contribution to the aggregates is
+ *  updated.
+ *
+ *  \param [in] user_data This adapter
+ *  \param [in] object    The object that changed
+ *  \return Always 0
+ */
+static int
+object_changed (void *user_data, LeptonObject *object)
+{
+  GschemSelectionAdapter *adapter = GSCHEM_SELECTION_ADAPTER (user_data);
+
+  if (g_hash_table_contains (adapter->aggregates->entries, object)) {
+    untrack_object (adapter, object);
+    track_object (adapter, object);
+  }
+
+  return 0;
 }
 
 
@@ -2303,6 +2032,49 @@ selection_changed (LeptonList *selection,
 
 
 
+/*! \private
+ *  \brief Signal handler for when an object is added to the selection
+ *
+ *  \param [in] selection The selection
+ *  \param [in] item      The added object
+ *  \param [in] adapter   This adapter
+ */
+static void
+selection_item_added (LeptonList *selection,
+                      gpointer item,
+                      GschemSelectionAdapter *adapter)
+{
+  g_return_if_fail (adapter != NULL);
+  g_return_if_fail (adapter->selection == selection);
+
+  track_object (adapter, (LeptonObject*) item);
+}
+
+
+
+/*! \private
+ *  \brief Signal handler for when an object is removed from the selection
+ *
+ *  \param [in] selection The selection
+ *  \param [in] item      The removed object
+ *  \param [in] adapter   This adapter
+ */
+static void
+selection_item_removed (LeptonList *selection,
+                        gpointer item,
+                        GschemSelectionAdapter *adapter)
+{
+  g_return_if_fail (adapter != NULL);
+  g_return_if_fail (adapter->selection == selection);
+
+  /* The object may still be in the list more than once */
+  if (!lepton_list_contains (selection, item)) {
+    untrack_object (adapter, (LeptonObject*) item);
+  }
+}
+
+
+
 /*! \brief Set a property
  *
  *  \param [in,out] object
@@ -2396,3 +2168,180 @@ set_property (GObject *object, guint param_id, const GValue *value, GParamSpec *
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
   }
 }
+
+
+
+/*! \private
+ *  \brief Add an object's properties to the aggregates
+ *
+ *  \par Function Description
+ *  Does nothing if the object has already been added.
+ *
+ *  \param [in] adapter This adapter
+ *  \param [in] object  The selected object
+ */
+static void
+track_object (GschemSelectionAdapter *adapter, LeptonObject *object)
+{
+  SelectionEntry *entry;
+  LeptonStrokeCapType cap_style;
+  LeptonStrokeType line_type;
+  gint line_width;
+  gint dash_length;
+  gint dash_space;
+  LeptonFillType fill_type;
+  gint fill_width;
+  gint pitch1;
+  gint angle1;
+  gint pitch2;
+  gint angle2;
+  gint index;
+
+  if ((object == NULL) ||
+      g_hash_table_contains (adapter->aggregates->entries, object)) {
+    return;
+  }
+
+  entry = g_new0 (SelectionEntry, 1);
+
+  if (lepton_object_get_line_options (object,
+                                      &cap_style,
+                                      &line_type,
+                                      &line_width,
+                                      &dash_length,
+                                      &dash_space)) {
+    entry_set (entry, AGGREGATE_CAP_STYLE, cap_style);
+    entry_set (entry, AGGREGATE_DASH_LENGTH, dash_length);
+    entry_set (entry, AGGREGATE_DASH_SPACE, dash_space);
+    entry_set (entry, AGGREGATE_LINE_TYPE, line_type);
+    entry_set (entry, AGGREGATE_LINE_WIDTH, line_width);
+  }
+
+  if (lepton_object_get_fill_options (object,
+                                      &fill_type,
+                                      &fill_width,
+                                      &pitch1,
+                                      &angle1,
+                                      &pitch2,
+                                      &angle2)) {
+    entry_set (entry, AGGREGATE_FILL_ANGLE1, angle1);
+    entry_set (entry, AGGREGATE_FILL_ANGLE2, angle2);
+    entry_set (entry, AGGREGATE_FILL_PITCH1, pitch1);
+    entry_set (entry, AGGREGATE_FILL_PITCH2, pitch2);
+    entry_set (entry, AGGREGATE_FILL_TYPE, fill_type);
+    entry_set (entry, AGGREGATE_FILL_WIDTH, fill_width);
+  }
+
+  if (lepton_object_is_arc (object)  ||
+      lepton_object_is_box (object)  ||
+      lepton_object_is_bus (object)  ||
+      lepton_object_is_net (object)  ||
+      lepton_object_is_line (object) ||
+      lepton_object_is_path (object) ||
+      lepton_object_is_text (object) ||
+      lepton_object_is_circle (object)) {
+    entry_set (entry, AGGREGATE_OBJECT_COLOR, lepton_object_get_color (object));
+  }
+
+  if (lepton_object_is_pin (object)) {
+    entry_set (entry, AGGREGATE_PIN_TYPE, object->pin_type);
+  }
+
+  if (lepton_object_is_text (object)) {
+    entry_set (entry, AGGREGATE_TEXT_ALIGNMENT, lepton_text_object_get_alignment (object));
+    entry_set (entry, AGGREGATE_TEXT_COLOR, lepton_object_get_color (object));
+    entry_set (entry, AGGREGATE_TEXT_ROTATION, lepton_text_object_get_angle (object));
+    entry_set (entry, AGGREGATE_TEXT_SIZE, lepton_text_object_get_size (object));
+
+    g_hash_table_add (adapter->aggregates->texts, object);
+  }
+
+  for (index = 0; index < AGGREGATE_COUNT; index++) {
+    if (entry->mask & (1u << index)) {
+      GHashTable *values = adapter->aggregates->values[index];
+      gpointer key = GINT_TO_POINTER (entry->values[index]);
+      guint count = GPOINTER_TO_UINT (g_hash_table_lookup (values, key));
+
+      g_hash_table_insert (values, key, GUINT_TO_POINTER (count + 1));
+    }
+  }
+
+  g_hash_table_insert (adapter->aggregates->entries, object, entry);
+}
+
+
+
+/*! \private
+ *  \brief Remove an object's properties from the aggregates
+ *
+ *  \par Function Description
+ *  The values recorded when the object was added are removed, so
+ *  this works even if the object has been changed since then.
+ *
+ *  \param [in] adapter This adapter
+ *  \param [in] object  The deselected object
+ */
+static void
+untrack_object (GschemSelectionAdapter *adapter, LeptonObject *object)
+{
+  SelectionEntry *entry;
+  gint index;
+
+  entry = (SelectionEntry*) g_hash_table_lookup (adapter->aggregates->entries,
+                                                 object);
+  if (entry == NULL) {
+    return;
+  }
+
+  for (index = 0; index < AGGREGATE_COUNT; index++) {
+    if (entry->mask & (1u << index)) {
+      GHashTable *values = adapter->aggregates->values[index];
+      gpointer key = GINT_TO_POINTER (entry->values[index]);
+      guint count = GPOINTER_TO_UINT (g_hash_table_lookup (values, key));
+
+      if (count > 1) {
+        g_hash_table_insert (values, key, GUINT_TO_POINTER (count - 1));
+      } else {
+        g_hash_table_remove (values, key);
+      }
+    }
+  }
+
+  g_hash_table_remove (adapter->aggregates->texts, object);
+  g_hash_table_remove (adapter->aggregates->entries, object);
+}
+
+
+
+/*! \private
+ *  \brief Recalculate the aggregates from scratch
+ *
+ *  \par Function Description
+ *  Used when the selection is replaced, and after changing
+ *  objects in ways that do not emit change notifications.
+ *
+ *  \param [in] adapter This adapter
+ */
+static void
+update_aggregates (GschemSelectionAdapter *adapter)
+{
+  GList *iter;
+  gint index;
+
+  g_hash_table_remove_all (adapter->aggregates->entries);
+  g_hash_table_remove_all (adapter->aggregates->texts);
+
+  for (index = 0; index < AGGREGATE_COUNT; index++) {
+    g_hash_table_remove_all (adapter->aggregates->values[index]);
+  }
+
+  if (adapter->selection == NULL) {
+    return;
+  }
+
+  for (iter = lepton_list_get_glist (adapter->selection);
+       iter != NULL;
+       iter = g_list_next (iter)) {
+    track_object (adapter, (LeptonObject*) iter->data);
+  }
+}
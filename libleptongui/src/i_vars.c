@@ -63,6 +63,8 @@ int   default_dots_grid_dot_size = 1;
 int   default_dots_grid_mode = DOTS_GRID_VARIABLE_MODE;
 int   default_dots_grid_fixed_threshold = 10;
 int   default_mesh_grid_display_threshold = 3;
+int   default_lod_size = 4;
+int   default_lod_symbol_size = 8;
 gboolean default_draw_grips = TRUE;
 
 int   default_auto_save_interval = 120;
@@ -382,6 +384,14 @@ i_vars_set (GschemToplevel* w_current)
                            default_mesh_grid_display_threshold, &w_current->mesh_grid_display_threshold,
                            &cfg_check_int_greater_0);
 
+  cfg_read_int_with_check ("schematic.gui", "lod-size",
+                           default_lod_size, &w_current->lod_size,
+                           &cfg_check_int_greater_eq_0);
+
+  cfg_read_int_with_check ("schematic.gui", "lod-symbol-size",
+                           default_lod_symbol_size, &w_current->lod_symbol_size,
+                           &cfg_check_int_greater_eq_0);
+
   cfg_read_int_with_check ("schematic.gui", "mousepan-gain",
                            default_mousepan_gain, &w_current->mousepan_gain,
                            &cfg_check_int_greater_0);
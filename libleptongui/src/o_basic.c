@@ -31,21 +31,352 @@ extern LeptonColorMap display_outline_colors;
  * readability issues
  */
 
-/*! \todo Finish function documentation!!!
- *  \brief
+/*! \brief Get the world rectangle of a screen region
+ *  \par Function Description
+ *  Converts the given region of the device space of \a cr to
+ *  world coordinates.  The region is bloated by \a bloat pixels
+ *  to catch cues and grips of objects lying just outside of it.
+ */
+static void
+screen_region_to_world_rect (cairo_t *cr,
+                             int x,
+                             int y,
+                             int width,
+                             int height,
+                             int bloat,
+                             LeptonBox *world_rect)
+{
+  double lower_x = x - bloat;
+  double lower_y = y + height + bloat;
+  double upper_x = x + width + bloat;
+  double upper_y = y - bloat;
+
+  cairo_device_to_user (cr, &lower_x, &lower_y);
+  cairo_device_to_user (cr, &upper_x, &upper_y);
+
+  world_rect->lower_x = floor (lower_x);
+  world_rect->lower_y = floor (lower_y);
+  world_rect->upper_x = ceil (upper_x);
+  world_rect->upper_y = ceil (upper_y);
+}
+
+
+/*! \brief Get objects which may be visible in a screen region
+ *  \par Function Description
+ *  Returns the list of objects of \a page which may be drawn in
+ *  the given region of the device space of \a cr, see
+ *  screen_region_to_world_rect().  The list should be freed with
+ *  g_list_free().
+ */
+static GList*
+objects_in_screen_region (cairo_t *cr,
+                          LeptonPage *page,
+                          int x,
+                          int y,
+                          int width,
+                          int height,
+                          int bloat,
+                          gboolean show_hidden_text)
+{
+  LeptonBox world_rect;
+
+  screen_region_to_world_rect (cr, x, y, width, height, bloat, &world_rect);
+
+  return lepton_page_objects_in_regions (page,
+                                         &world_rect,
+                                         1,
+                                         show_hidden_text);
+}
+
+
+/*! \brief Test if an object may be visible in any of world rectangles
+ */
+static gboolean
+object_in_world_rects (LeptonObject *object,
+                       LeptonBox *rects,
+                       int n_rects,
+                       gboolean show_hidden_text)
+{
+  int left, top, right, bottom;
+  int i;
+
+  if (!lepton_object_calculate_visible_bounds (object,
+                                               show_hidden_text,
+                                               &left,
+                                               &top,
+                                               &right,
+                                               &bottom)) {
+    return FALSE;
+  }
+
+  for (i = 0; i < n_rects; i++) {
+    if (right  >= rects[i].lower_x &&
+        left   <= rects[i].upper_x &&
+        top    <= rects[i].upper_y &&
+        bottom >= rects[i].lower_y) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+/*! \brief Get the rectangles to redraw in the user space of a context
  *  \par Function Description
+ *  Returns an array of GdkRectangle structures covering the clip
+ *  region of \a cr, which must be set up for drawing in widget
+ *  coordinates.  If the clip region cannot be represented by
+ *  rectangles, its extents are returned.
+ */
+static GArray*
+clip_rectangles (cairo_t *cr)
+{
+  GArray *rects = g_array_new (FALSE, FALSE, sizeof (GdkRectangle));
+  cairo_rectangle_list_t *list = cairo_copy_clip_rectangle_list (cr);
+  GdkRectangle rect;
+  int i;
+
+  if (list->status == CAIRO_STATUS_SUCCESS) {
+    for (i = 0; i < list->num_rectangles; i++) {
+      cairo_rectangle_t *r = &(list->rectangles[i]);
+
+      rect.x = floor (r->x);
+      rect.y = floor (r->y);
+      rect.width = ceil (r->x + r->width) - rect.x;
+      rect.height = ceil (r->y + r->height) - rect.y;
+      g_array_append_val (rects, rect);
+    }
+  } else {
+    double x1, y1, x2, y2;
+
+    cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+    rect.x = floor (x1);
+    rect.y = floor (y1);
+    rect.width = ceil (x2) - rect.x;
+    rect.height = ceil (y2) - rect.y;
+    g_array_append_val (rects, rect);
+  }
+
+  cairo_rectangle_list_destroy (list);
+
+  return rects;
+}
+
+
+/*! \brief Draw the page layer in a screen region
+ *  \par Function Description
+ *  Paints the background and the grid, and draws the objects of
+ *  \a obj_list which are neither selected nor being modified,
+ *  along with their cues.  The region is given in the device
+ *  space of \a cr.
+ */
+static void
+draw_page_layer (GschemToplevel *w_current,
+                 EdaRenderer *renderer,
+                 cairo_t *cr,
+                 GList *obj_list,
+                 int x,
+                 int y,
+                 int width,
+                 int height)
+{
+  GList *iter;
+
+  /* Paint background */
+  LeptonColor *color = x_color_lookup (BACKGROUND_COLOR);
+
+  cairo_set_source_rgba (cr,
+                         lepton_color_get_red_double (color),
+                         lepton_color_get_green_double (color),
+                         lepton_color_get_blue_double (color),
+                         lepton_color_get_alpha_double (color));
+  cairo_paint (cr);
+
+  /* Draw grid lines */
+  x_grid_draw_region (w_current, cr, x, y, width, height);
+
+  /* First pass -- render non-selected objects */
+  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
+    LeptonObject *o_current = (LeptonObject*) iter->data;
+
+    if (!(o_current->dont_redraw
+          || lepton_object_get_selected (o_current)))
+    {
+      eda_renderer_draw (renderer, o_current);
+    }
+  }
+
+  /* Second pass -- render cues */
+  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
+    LeptonObject *o_current = (LeptonObject*) iter->data;
+
+    if (!(o_current->dont_redraw
+          || lepton_object_get_selected (o_current)))
+    {
+      eda_renderer_draw_cues (renderer, o_current);
+    }
+  }
+}
+
+
+/*! \brief Render a tile of the page layer
+ *  \par Function Description
+ *  Creates a new surface of GSCHEM_PAGE_VIEW_TILE_SIZE pixels
+ *  square compatible with the target of \a cr and draws on it the
+ *  page layer at the given tile column and row.  \a page_matrix
+ *  transforms world coordinates to page pixel coordinates.  The
+ *  renderer is temporarily switched to the tile context.
  *
+ *  \return The new surface, to be freed with cairo_surface_destroy().
+ */
+static cairo_surface_t*
+render_page_tile (GschemToplevel *w_current,
+                  EdaRenderer *renderer,
+                  cairo_t *cr,
+                  LeptonPage *page,
+                  const cairo_matrix_t *page_matrix,
+                  int column,
+                  int row,
+                  int bloat,
+                  gboolean show_hidden_text)
+{
+  int size = GSCHEM_PAGE_VIEW_TILE_SIZE;
+  cairo_matrix_t tile_matrix = *page_matrix;
+  cairo_surface_t *surface;
+  cairo_t *tile_cr;
+  GList *obj_list;
+
+  surface = cairo_surface_create_similar (cairo_get_target (cr),
+                                          CAIRO_CONTENT_COLOR_ALPHA,
+                                          size,
+                                          size);
+  tile_cr = cairo_create (surface);
+
+  tile_matrix.x0 = - (double) column * size;
+  tile_matrix.y0 = - (double) row * size;
+  cairo_set_matrix (tile_cr, &tile_matrix);
+
+  obj_list = objects_in_screen_region (tile_cr, page,
+                                       0, 0, size, size,
+                                       bloat, show_hidden_text);
+
+  g_object_set (G_OBJECT (renderer), "cairo-context", tile_cr, NULL);
+  draw_page_layer (w_current, renderer, tile_cr, obj_list, 0, 0, size, size);
+  g_object_set (G_OBJECT (renderer), "cairo-context", cr, NULL);
+
+  g_list_free (obj_list);
+  cairo_destroy (tile_cr);
+
+  return surface;
+}
+
+
+/*! \brief Draw the page layer in a screen region from cached tiles
+ *  \par Function Description
+ *  Paints the tiles of the page layer covering the given region
+ *  of the view.  Missing tiles are rendered and added to the tile
+ *  cache of \a view.  Tiles rendered in the outline mode used
+ *  while panning are never cached.  \a matrix is the world to
+ *  screen matrix, which must have an integer translation, and
+ *  (\a dx, \a dy) is the position of the view in the device space
+ *  of \a cr.
+ */
+static void
+draw_page_tiles (GschemToplevel *w_current,
+                 GschemPageView *view,
+                 EdaRenderer *renderer,
+                 cairo_t *cr,
+                 LeptonPage *page,
+                 const cairo_matrix_t *matrix,
+                 int dx,
+                 int dy,
+                 int x,
+                 int y,
+                 int width,
+                 int height,
+                 int bloat,
+                 int render_flags,
+                 gboolean show_hidden_text)
+{
+  int size = GSCHEM_PAGE_VIEW_TILE_SIZE;
+  int origin_x = (int) matrix->x0;
+  int origin_y = (int) matrix->y0;
+  int tile_flags = render_flags & ~(EDA_RENDERER_FLAG_TEXT_OUTLINE
+                                    | EDA_RENDERER_FLAG_PICTURE_OUTLINE);
+  gboolean cacheable = (tile_flags == render_flags);
+  cairo_matrix_t page_matrix = *matrix;
+  int first_column, last_column, first_row, last_row;
+  int column, row;
+
+  /* Page pixel coordinates have their origin at the world origin */
+  page_matrix.x0 = 0;
+  page_matrix.y0 = 0;
+
+  first_column = (int) floor ((double) (x - origin_x) / size);
+  last_column = (int) floor ((double) (x + width - 1 - origin_x) / size);
+  first_row = (int) floor ((double) (y - origin_y) / size);
+  last_row = (int) floor ((double) (y + height - 1 - origin_y) / size);
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+  cairo_translate (cr, dx, dy);
+
+  for (row = first_row; row <= last_row; row++) {
+    for (column = first_column; column <= last_column; column++) {
+      cairo_surface_t *surface =
+        gschem_page_view_lookup_tile (view, column, row, tile_flags);
+
+      if (surface != NULL) {
+        cairo_surface_reference (surface);
+      } else {
+        surface = render_page_tile (w_current, renderer, cr, page,
+                                    &page_matrix, column, row,
+                                    bloat, show_hidden_text);
+        if (cacheable) {
+          gschem_page_view_insert_tile (view, column, row,
+                                        tile_flags, surface);
+        }
+      }
+
+      cairo_set_source_surface (cr, surface,
+                                origin_x + column * size,
+                                origin_y + row * size);
+      cairo_rectangle (cr,
+                       origin_x + column * size,
+                       origin_y + row * size,
+                       size,
+                       size);
+      cairo_fill (cr);
+
+      cairo_surface_destroy (surface);
+    }
+  }
+
+  cairo_restore (cr);
+}
+
+
+/*! \brief Redraw a region of a page view
+ *  \par Function Description
+ *  The page layer, that is, the background, the grid, and the
+ *  objects which are neither selected nor being modified, is
+ *  painted from the tile cache of \a view.  The selection, its
+ *  cues and grips, and the rubber band objects of the current
+ *  action are drawn over it.  Only the damaged region, that is,
+ *  the clip region of the cairo context in GTK3 or the exposed
+ *  rectangle in GTK2, is redrawn.
  */
 #ifdef ENABLE_GTK3
 void
 o_redraw_rect (GschemToplevel *w_current,
-               GtkWidget *widget,
+               GschemPageView *view,
                LeptonPage *page,
                GschemPageGeometry *geometry,
                cairo_t *cr)
 #else
 void o_redraw_rect (GschemToplevel *w_current,
-                    GdkDrawable *drawable,
+                    GschemPageView *view,
                     LeptonPage *page,
                     GschemPageGeometry *geometry,
                     GdkRectangle *rectangle)
@@ -56,78 +387,75 @@ void o_redraw_rect (GschemToplevel *w_current,
   double cue_half_size;
   int bloat;
   double dummy = 0.0;
-  GList *obj_list;
   GList *iter;
-  LeptonBox *world_rect;
+  cairo_matrix_t matrix;
   EdaRenderer *renderer;
   int render_flags;
   GArray *render_color_map = NULL;
   GArray *render_outline_color_map = NULL;
+  GArray *clip_rects;
+  LeptonBox *world_rects;
+  guint i;
 #ifndef ENABLE_GTK3
   cairo_t *cr;
 #endif
 
   g_return_if_fail (w_current != NULL);
+  g_return_if_fail (view != NULL);
   g_return_if_fail (page != NULL);
   g_return_if_fail (geometry != NULL);
 #ifndef ENABLE_GTK3
-  cr = gdk_cairo_create (drawable);
+  cr = gdk_cairo_create (gtk_widget_get_window (GTK_WIDGET (view)));
 
   gdk_cairo_rectangle (cr, rectangle);
   cairo_clip (cr);
 
   cairo_save (cr);
+
+  clip_rects = g_array_new (FALSE, FALSE, sizeof (GdkRectangle));
+  g_array_append_val (clip_rects, *rectangle);
+#else
+  /* Only the damaged region has to be redrawn */
+  clip_rects = clip_rectangles (cr);
 #endif
-  cairo_set_matrix (cr, gschem_page_geometry_get_world_to_screen_matrix (geometry));
+  /* Round the translation to whole pixels so that cached tiles
+   * line up with objects drawn directly. */
+  matrix = *gschem_page_geometry_get_world_to_screen_matrix (geometry);
+  matrix.x0 = round (matrix.x0);
+  matrix.y0 = round (matrix.y0);
+  cairo_set_matrix (cr, &matrix);
 
   grip_half_size = GRIP_SIZE / 2;
   cue_half_size = CUE_BOX_SIZE;
   cairo_user_to_device (cr, &cue_half_size, &dummy);
   bloat = MAX (grip_half_size, (int)cue_half_size);
 
-
-  world_rect = g_new (LeptonBox, 1);
-
 #ifdef ENABLE_GTK3
   gint wx, wy;
   gtk_widget_translate_coordinates (w_current->drawing_area,
                                     gtk_widget_get_toplevel (w_current->drawing_area),
                                     0, 0, &wx, &wy);
-
-  gint x = 0;
-  gint y = 0;
-  gint width = gtk_widget_get_allocated_width (GTK_WIDGET (widget));
-  gint height = gtk_widget_get_allocated_height (GTK_WIDGET (widget));
-
-  double lower_x = x - bloat;
-  double lower_y = y + height + bloat;
-  double upper_x = x + width + bloat;
-  double upper_y = y - bloat;
 #else
-  double lower_x = rectangle->x - bloat;
-  double lower_y = rectangle->y + rectangle->height + bloat;
-  double upper_x = rectangle->x + rectangle->width + bloat;
-  double upper_y = rectangle->y - bloat;
+  gint wx = 0;
+  gint wy = 0;
 #endif
 
-  cairo_device_to_user (cr, &lower_x, &lower_y);
-  cairo_device_to_user (cr, &upper_x, &upper_y);
-
-  world_rect->lower_x = floor (lower_x);
-  world_rect->lower_y = floor (lower_y);
-  world_rect->upper_x = ceil (upper_x);
-  world_rect->upper_y = ceil (upper_y);
+  /* World rectangles of the damaged region used to skip selected
+   * objects lying outside of it */
+  world_rects = g_new (LeptonBox, clip_rects->len);
+  for (i = 0; i < clip_rects->len; i++) {
+    GdkRectangle *rect = &g_array_index (clip_rects, GdkRectangle, i);
+
+    screen_region_to_world_rect (cr,
+                                 rect->x, rect->y,
+                                 rect->width, rect->height,
+                                 bloat,
+                                 &world_rects[i]);
+  }
 
   gboolean show_hidden_text =
     gschem_toplevel_get_show_hidden_text (w_current);
 
-  obj_list = lepton_page_objects_in_regions (page,
-                                             world_rect,
-                                             1,
-                                             show_hidden_text);
-
-  g_free (world_rect);
-
   /* Set up renderer based on configuration in w_current */
   render_flags = EDA_RENDERER_FLAG_HINTING;
   if (show_hidden_text)
@@ -158,34 +486,25 @@ void o_redraw_rect (GschemToplevel *w_current,
                 "grip-size", ((double) grip_half_size * geometry->to_world_x_constant),
                 "render-flags", render_flags,
                 "color-map", render_color_map,
+                "lod-size", (double) w_current->lod_size,
+                "lod-symbol-size", (double) w_current->lod_symbol_size,
                 NULL);
 
-  /* Paint background */
-  LeptonColor *color = x_color_lookup (BACKGROUND_COLOR);
+  /* Paint background, grid, and non-selected objects */
+  for (i = 0; i < clip_rects->len; i++) {
+    GdkRectangle *rect = &g_array_index (clip_rects, GdkRectangle, i);
 
-  cairo_set_source_rgba (cr,
-                         lepton_color_get_red_double (color),
-                         lepton_color_get_green_double (color),
-                         lepton_color_get_blue_double (color),
-                         lepton_color_get_alpha_double (color));
+    draw_page_tiles (w_current, view, renderer, cr, page, &matrix,
+                     wx, wy,
+                     rect->x, rect->y, rect->width, rect->height,
+                     bloat, render_flags, show_hidden_text);
+  }
 
 #ifdef ENABLE_GTK3
   double cx=wx, cy=wy;
   cairo_device_to_user_distance (cr, &cx, &cy);
   cairo_translate (cr, cx, cy);
 #endif
-  cairo_paint (cr);
-
-  /* Draw grid lines */
-#ifdef ENABLE_GTK3
-  x_grid_draw_region (w_current, cr,
-                      wx, wy,
-                      width, height);
-#else
-  x_grid_draw_region (w_current, cr,
-                      rectangle->x, rectangle->y,
-                      rectangle->width, rectangle->height);
-#endif
 
   SchematicActionMode action_mode =
     schematic_window_get_action_mode (w_current);
@@ -194,28 +513,6 @@ void o_redraw_rect (GschemToplevel *w_current,
   draw_selected = !(w_current->inside_action &&
                     (action_mode == MOVEMODE));
 
-  /* First pass -- render non-selected objects */
-  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
-    LeptonObject *o_current = (LeptonObject*) iter->data;
-
-    if (!(o_current->dont_redraw
-          || lepton_object_get_selected (o_current)))
-    {
-      eda_renderer_draw (renderer, o_current);
-    }
-  }
-
-  /* Second pass -- render cues */
-  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
-    LeptonObject *o_current = (LeptonObject*) iter->data;
-
-    if (!(o_current->dont_redraw
-          || lepton_object_get_selected (o_current)))
-    {
-      eda_renderer_draw_cues (renderer, o_current);
-    }
-  }
-
   /* Second pass -- render selected objects, cues & grips. This is
    * done in a separate pass to non-selected items to make sure that
    * the selection and grips are never obscured by other objects. */
@@ -226,7 +523,11 @@ void o_redraw_rect (GschemToplevel *w_current,
     for (iter = lepton_list_get_glist (page->selection_list);
          iter != NULL; iter = g_list_next (iter)) {
       LeptonObject *o_current = (LeptonObject*) iter->data;
-      if (!o_current->dont_redraw) {
+      if (!o_current->dont_redraw
+          && object_in_world_rects (o_current,
+                                    world_rects,
+                                    clip_rects->len,
+                                    show_hidden_text)) {
         eda_renderer_draw (renderer, o_current);
         eda_renderer_draw_cues (renderer, o_current);
         if (w_current->draw_grips) {
@@ -315,8 +616,9 @@ void o_redraw_rect (GschemToplevel *w_current,
     }
   }
 
-  g_list_free (obj_list);
   g_object_unref (G_OBJECT (renderer));
+  g_free (world_rects);
+  g_array_free (clip_rects, TRUE);
   g_array_free (render_color_map, TRUE);
   g_array_free (render_outline_color_map, TRUE);
 
@@ -433,7 +735,7 @@ int o_redraw_cleanstates(GschemToplevel *w_current)
       i_set_state(w_current, SELECT);
 
       /* from i_callback_cancel() */
-      gschem_page_view_invalidate_all (gschem_toplevel_get_current_page_view (w_current));
+      gschem_page_view_invalidate_window (gschem_toplevel_get_current_page_view (w_current));
       return TRUE;
 
     /* all remaining states without dc changes */
@@ -493,8 +795,11 @@ void o_invalidate_rect (GschemToplevel *w_current,
 /*! \brief Invalidate on-screen area for an object
  *
  *  \par Function Description
- *  This function calls o_invalidate_rect() with the bounds of the
- *  passed LeptonObject, converted to screen coordinates.
+ *  This function adds the bounds of the passed LeptonObject to the
+ *  damaged region of the current page view.  Both the last bounds
+ *  calculated for the object and its current bounds are damaged,
+ *  so the function may be used as both pre-change and change
+ *  notification handler.
  *
  *  \param [in] w_current  The GschemToplevel object.
  *  \param [in] object     The LeptonObject invalidated on screen.
@@ -504,6 +809,7 @@ void o_invalidate (GschemToplevel *w_current, LeptonObject *object)
   if (w_current == NULL || w_current->dont_invalidate) return;
 
   int left, top, bottom, right;
+  LeptonBounds old_bounds;
 
   GschemPageView *page_view = gschem_toplevel_get_current_page_view (w_current);
   LeptonPage *page = gschem_page_view_get_page (page_view);
@@ -515,6 +821,17 @@ void o_invalidate (GschemToplevel *w_current, LeptonObject *object)
     return;
   }
 
+  /* The object may have been changed without pre-change
+   * notification, so damage the area it occupied before, too. */
+  old_bounds = object->bounds;
+  if (!lepton_bounds_empty (&old_bounds)) {
+    gschem_page_view_damage_world_rect (page_view,
+                                        old_bounds.min_x,
+                                        old_bounds.min_y,
+                                        old_bounds.max_x,
+                                        old_bounds.max_y);
+  }
+
   if (lepton_object_calculate_visible_bounds (object,
                                               show_hidden_text,
                                               &left,
@@ -522,7 +839,7 @@ void o_invalidate (GschemToplevel *w_current, LeptonObject *object)
                                               &right,
                                               &bottom))
   {
-    gschem_page_view_invalidate_world_rect (page_view,
+    gschem_page_view_damage_world_rect (page_view,
                                             left,
                                             top,
                                             right,
@@ -559,7 +876,7 @@ void o_invalidate_glist (GschemToplevel *w_current, GList *list)
                                      &top,
                                      &right,
                                      &bottom)) {
-    gschem_page_view_invalidate_world_rect (page_view,
+    gschem_page_view_damage_world_rect (page_view,
                                             left,
                                             top,
                                             right,
@@ -113,11 +113,13 @@ void o_delete_selected (GschemToplevel *w_current)
     }
   }
 
+  lepton_list_begin_update (selection);
   for (iter = to_remove; iter != NULL; iter = g_list_next (iter)) {
     obj = (LeptonObject *) iter->data;
     o_selection_remove (selection, obj);
     lepton_page_remove (active_page, obj);
   }
+  lepton_list_end_update (selection);
 
   g_run_hook_object_list (w_current, "remove-objects-hook", to_remove);
 
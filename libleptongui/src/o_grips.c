@@ -1006,6 +1006,7 @@ void o_grips_cancel(GschemToplevel *w_current)
   /* Switch drawing of the object back on */
   g_return_if_fail (object != NULL);
   object->dont_redraw = FALSE;
+  o_invalidate (w_current, object);
 }
 
 
@@ -305,7 +305,6 @@ void o_edit_hide_specific_text (GschemToplevel *w_current,
     iter = g_list_next (iter);
   }
   o_undo_savestate_old(w_current, UNDO_ALL);
-  gschem_page_view_invalidate_all (gschem_toplevel_get_current_page_view (w_current));
 }
 
 /*! \todo Finish function documentation!!!
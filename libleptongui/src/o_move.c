@@ -182,6 +182,7 @@ void o_move_end(GschemToplevel *w_current)
        s_iter != NULL; s_iter = g_list_next (s_iter)) {
     STRETCH *stretch = (STRETCH*) s_iter->data;
     stretch->object->dont_redraw = FALSE;
+    o_invalidate (w_current, stretch->object);
   }
 
   s_current = lepton_list_get_glist( page->selection_list );
@@ -267,6 +268,7 @@ void o_move_cancel (GschemToplevel *w_current)
        s_iter != NULL; s_iter = g_list_next (s_iter)) {
     STRETCH *stretch = (STRETCH*) s_iter->data;
     stretch->object->dont_redraw = FALSE;
+    o_invalidate (w_current, stretch->object);
   }
   g_list_free(page->place_list);
   page->place_list = NULL;
@@ -531,8 +533,8 @@ int o_move_return_whichone(LeptonObject * object, int x, int y)
  */
 void o_move_check_endpoint(GschemToplevel *w_current, LeptonObject * object)
 {
-  GList *cl_current;
-  LeptonConn *c_current;
+  LeptonConnIter iter;
+  LeptonConn conn;
   LeptonObject *other;
   int whichone;
 
@@ -547,12 +549,10 @@ void o_move_check_endpoint(GschemToplevel *w_current, LeptonObject * object)
   LeptonPage *page = gschem_page_view_get_page (page_view);
   g_return_if_fail (page != NULL);
 
-  for (cl_current = object->conn_list;
-       cl_current != NULL;
-       cl_current = g_list_next(cl_current)) {
+  s_conn_iter_init (&iter, object);
+  while (s_conn_iter_next (&iter, &conn)) {
 
-    c_current = (LeptonConn *) cl_current->data;
-    other = c_current->other_object;
+    other = conn.other_object;
 
     if (other == NULL)
       continue;
@@ -566,9 +566,9 @@ void o_move_check_endpoint(GschemToplevel *w_current, LeptonObject * object)
     if (parent != NULL && lepton_object_get_selected (parent))
       continue;
 
-    if (c_current->type != CONN_ENDPOINT &&
-        (c_current->type != CONN_MIDPOINT ||
-         c_current->other_whichone == -1))
+    if (conn.type != CONN_ENDPOINT &&
+        (conn.type != CONN_MIDPOINT ||
+         conn.other_whichone == -1))
       continue;
 
     if (/* (net)pin to (net)pin contact */
@@ -582,10 +582,10 @@ void o_move_check_endpoint(GschemToplevel *w_current, LeptonObject * object)
       LeptonObject *new_net;
       /* other object is a pin, insert a net */
       new_net = lepton_net_object_new (NET_COLOR,
-                                       c_current->x,
-                                       c_current->y,
-                                       c_current->x,
-                                       c_current->y);
+                                       conn.x,
+                                       conn.y,
+                                       conn.x,
+                                       conn.y);
       lepton_page_append (page, new_net);
       /* This new net object is only picked up for stretching later,
        * somewhat of a kludge. If the move operation is cancelled, these
@@ -597,17 +597,17 @@ void o_move_check_endpoint(GschemToplevel *w_current, LeptonObject * object)
     if (!lepton_object_is_net (other) && !lepton_object_is_bus (other))
       continue;
 
-    whichone = o_move_return_whichone (other, c_current->x, c_current->y);
+    whichone = o_move_return_whichone (other, conn.x, conn.y);
 
 #if DEBUG
     printf ("FOUND: %s type: %d, whichone: %d, x,y: %d %d\n",
-            other->name, c_current->type,
-            whichone, c_current->x, c_current->y);
+            other->name, conn.type,
+            whichone, conn.x, conn.y);
 
-    printf("other x,y: %d %d\n", c_current->x, c_current->y);
+    printf("other x,y: %d %d\n", conn.x, conn.y);
     printf("type: %d return: %d real: [ %d %d ]\n",
-           c_current->type, whichone, c_current->whichone,
-           c_current->other_whichone);
+           conn.type, whichone, conn.whichone,
+           conn.other_whichone);
 #endif
 
     if (whichone >= 0 && whichone <= 1) {
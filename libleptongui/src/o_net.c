@@ -534,12 +534,11 @@ void o_net_end(GschemToplevel *w_current, int w_x, int w_y)
 
 #if DEBUG
       printf("primary:\n");
-      s_conn_print(new_net->conn_list);
+      s_conn_print (new_net);
 #endif
 
       /* Go off and search for valid connection on this newly created net */
-      found_primary_connection = s_conn_net_search(new_net, 1,
-                                                   new_net->conn_list);
+      found_primary_connection = s_conn_net_search (new_net, 1);
       if (found_primary_connection)
       {
         /* if a net connection is found, reset start point of next net */
@@ -569,7 +568,7 @@ void o_net_end(GschemToplevel *w_current, int w_x, int w_y)
       o_net_add_busrippers (w_current, new_net, prev_conn_objects);
       g_list_free (prev_conn_objects);
 #if DEBUG
-      s_conn_print(new_net->conn_list);
+      s_conn_print (new_net);
 #endif
   }
 
@@ -767,6 +766,9 @@ int o_net_add_busrippers(GschemToplevel *w_current, LeptonObject *net_obj,
   LeptonObject *new_obj;
   GList *cl_current = NULL;
   LeptonObject *bus_object = NULL;
+  LeptonConnIter iter;
+  LeptonConn conn;
+  LeptonConn bus_conn;
   LeptonConn *found_conn = NULL;
   int done;
   int otherone;
@@ -810,19 +812,15 @@ int o_net_add_busrippers(GschemToplevel *w_current, LeptonObject *net_obj,
       int net_orientation = lepton_net_object_orientation (net_obj);
 
       /* find the LeptonConn structure which is associated with this object */
-      GList *cl_current2 = net_obj->conn_list;
+      s_conn_iter_init (&iter, net_obj);
       done = FALSE;
-      while (cl_current2 != NULL && !done) {
-        LeptonConn *tmp_conn = (LeptonConn *) cl_current2->data;
+      while (!done && s_conn_iter_next (&iter, &conn)) {
+        if (conn.other_object == bus_object) {
 
-        if (tmp_conn && tmp_conn->other_object &&
-            tmp_conn->other_object == bus_object) {
-
-          found_conn = tmp_conn;
+          bus_conn = conn;
+          found_conn = &bus_conn;
           done = TRUE;
         }
-
-        cl_current2 = g_list_next(cl_current2);
       }
 
       if (!found_conn) {
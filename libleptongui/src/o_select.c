@@ -170,6 +170,9 @@ void o_select_object(GschemToplevel *w_current, LeptonObject *o_current,
   printf("LeptonObject id: %d\n", lepton_object_get_id (o_current));
 #endif
 
+  /* Notify about the whole change at once */
+  lepton_list_begin_update (toplevel->page_current->selection_list);
+
   switch (lepton_object_get_selected (o_current))
   {
 
@@ -280,6 +283,8 @@ void o_select_object(GschemToplevel *w_current, LeptonObject *o_current,
                              o_current);
     }
   }
+
+  lepton_list_end_update (toplevel->page_current->selection_list);
 }
 
 /*! \todo Finish function documentation!!!
@@ -389,7 +394,9 @@ void o_select_box_search(GschemToplevel *w_current)
   int SHIFTKEY = w_current->SHIFTKEY;
   int CONTROLKEY = w_current->CONTROLKEY;
   int left, right, top, bottom;
-  const GList *iter;
+  GList *candidates;
+  GList *iter;
+  LeptonBox region;
   gboolean show_hidden_text =
     gschem_toplevel_get_show_hidden_text (w_current);
 
@@ -400,7 +407,19 @@ void o_select_box_search(GschemToplevel *w_current)
 
   LeptonPage *active_page = schematic_window_get_active_page (w_current);
 
-  iter = lepton_page_objects (active_page);
+  /* Only objects intersecting the box can be inside it */
+  region.lower_x = left;
+  region.lower_y = top;
+  region.upper_x = right;
+  region.upper_y = bottom;
+  candidates = lepton_page_objects_in_regions (active_page,
+                                               &region,
+                                               1,
+                                               show_hidden_text);
+
+  lepton_list_begin_update (active_page->selection_list);
+
+  iter = candidates;
   while (iter != NULL) {
     o_current = (LeptonObject*) iter->data;
     /* only select visible objects */
@@ -428,6 +447,7 @@ void o_select_box_search(GschemToplevel *w_current)
     }
     iter = g_list_next (iter);
   }
+  g_list_free (candidates);
 
   /* if there were no objects to be found in select box, count will be */
   /* zero, and you need to deselect anything remaining (except when the */
@@ -435,6 +455,8 @@ void o_select_box_search(GschemToplevel *w_current)
   if (count == 0 && !SHIFTKEY && !CONTROLKEY) {
     o_select_unselect_all (w_current);
   }
+
+  lepton_list_end_update (active_page->selection_list);
   i_update_menus(w_current);
 }
 
@@ -469,6 +491,9 @@ void o_select_connected_nets(GschemToplevel *w_current, LeptonObject* o_net)
     return;
   }
 
+  LeptonPage *page = schematic_window_get_active_page (w_current);
+  lepton_list_begin_update (page->selection_list);
+
   if (!lepton_object_get_selected (o_net))
   {
     w_current->net_selection_state = 1;
@@ -545,6 +570,8 @@ void o_select_connected_nets(GschemToplevel *w_current, LeptonObject* o_net)
   for (iter1 = netnamestack; iter1 != NULL; iter1 = g_list_next(iter1))
     g_free(iter1->data);
   g_list_free(netnamestack);
+
+  lepton_list_end_update (page->selection_list);
 }
 
 /* This is a wrapper for o_selection_return_first_object */
@@ -590,9 +617,12 @@ void o_select_unselect_all(GschemToplevel *w_current)
   GList *iter;
 
   removed = g_list_copy (lepton_list_get_glist (selection));
+
+  lepton_list_begin_update (selection);
   for (iter = removed; iter != NULL; iter = g_list_next (iter)) {
     o_selection_remove (selection, (LeptonObject *) iter->data);
   }
+  lepton_list_end_update (selection);
 
   /* Call hooks */
   if (removed != NULL) {
@@ -30,6 +30,310 @@
 
 #define MESH_COARSE_GRID_MULTIPLIER  5
 
+/* Maximum width and height in pixels of the grid pattern tile */
+#define GRID_TILE_MAX_SIZE           1024
+
+/* Repeating the grid pattern tile may shift grid elements by at
+ * most one pixel per this number of pixels */
+#define GRID_TILE_PRECISION          4096
+
+
+/* Parameters the cached grid pattern was rendered with */
+typedef struct
+{
+  SchematicGridMode mode;
+  double period_x;      /* Grid spacing in pixels */
+  double period_y;
+  int multiplier;       /* Number of grid steps per pattern period */
+  int dot_size;
+  gboolean fine;        /* If the fine mesh is drawn */
+  double color[2][4];
+} GridPatternKey;
+
+static GridPatternKey grid_pattern_key;
+static cairo_pattern_t *grid_pattern = NULL;
+
+
+/*! \brief Find the size of a grid pattern tile
+ *
+ *  \par Function Description
+ *  Finds the smallest number of grid periods which add up to a
+ *  whole number of pixels precisely enough to repeat the tile
+ *  without visible drift of grid elements.
+ *
+ *  \param [in]  period The grid period in pixels.
+ *  \param [out] count  The number of periods in the tile.
+ *  \param [out] size   The size of the tile in pixels.
+ *  \returns TRUE if a suitable tile size has been found.
+ */
+static gboolean
+grid_tile_size (double period, int *count, int *size)
+{
+  int n;
+
+  if (period < 1) {
+    return FALSE;
+  }
+
+  for (n = 1; n * period <= GRID_TILE_MAX_SIZE; n++) {
+    double length = n * period;
+    int pixels = (int) round (length);
+
+    if (fabs (length - pixels) * GRID_TILE_PRECISION <= length) {
+      *count = n;
+      *size = pixels;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
+static void
+grid_key_set_color (GridPatternKey *key, int index, LeptonColor *color)
+{
+  key->color[index][0] = lepton_color_get_red_double (color);
+  key->color[index][1] = lepton_color_get_green_double (color);
+  key->color[index][2] = lepton_color_get_blue_double (color);
+  key->color[index][3] = lepton_color_get_alpha_double (color);
+}
+
+
+static void
+grid_set_source_color (cairo_t *cr, const GridPatternKey *key, int index)
+{
+  cairo_set_source_rgba (cr,
+                         key->color[index][0],
+                         key->color[index][1],
+                         key->color[index][2],
+                         key->color[index][3]);
+}
+
+
+/*! \brief Render the dots grid tile
+ *
+ *  \par Function Description
+ *  Dots are also drawn shifted by the tile size, so that the parts
+ *  of dots crossing the tile edges appear on the opposite side.
+ */
+static void
+render_dots_tile (cairo_t *cr,
+                  const GridPatternKey *key,
+                  int columns, int rows, int width, int height)
+{
+  int i, j, dx, dy;
+
+  grid_set_source_color (cr, key, 0);
+
+  for (j = 0; j < rows; j++) {
+    for (i = 0; i < columns; i++) {
+      double x1 = round (i * key->period_x);
+      double y1 = round (j * key->period_y);
+
+      if (key->dot_size == 1) {
+        cairo_rectangle (cr, x1, y1, 1, 1);
+        continue;
+      }
+
+      for (dy = -height; dy <= height; dy += height) {
+        for (dx = -width; dx <= width; dx += width) {
+          cairo_move_to (cr, x1 + dx, y1 + dy);
+          cairo_arc (cr, x1 + dx, y1 + dy,
+                     key->dot_size/2,
+                     0,
+                     2*M_PI);
+        }
+      }
+    }
+  }
+
+  cairo_fill (cr);
+}
+
+
+/*! \brief Render the mesh grid tile
+ *
+ *  \par Function Description
+ *  The tile starts at a line of the coarse grid.  Lines of the
+ *  fine grid which coincide with those of the coarse grid are
+ *  skipped.
+ */
+static void
+render_mesh_tile (cairo_t *cr,
+                  const GridPatternKey *key,
+                  int columns, int rows, int width, int height)
+{
+  int i, pass;
+
+  cairo_set_line_width (cr, 1.);
+  cairo_translate (cr, 0.5, 0.5);
+
+  for (pass = key->fine ? 1 : 0; pass >= 0; pass--) {
+    gboolean coarse = (pass == 0);
+
+    grid_set_source_color (cr, key, pass);
+
+    for (i = 0; i < rows * key->multiplier; i++) {
+      double y1 = round (i * key->period_y);
+
+      if (coarse == (i % key->multiplier != 0)) {
+        continue;
+      }
+      cairo_move_to (cr, -1, y1);
+      cairo_line_to (cr, width + 1, y1);
+    }
+
+    for (i = 0; i < columns * key->multiplier; i++) {
+      double x1 = round (i * key->period_x);
+
+      if (coarse == (i % key->multiplier != 0)) {
+        continue;
+      }
+      cairo_move_to (cr, x1, -1);
+      cairo_line_to (cr, x1, height + 1);
+    }
+
+    cairo_stroke (cr);
+  }
+}
+
+
+/*! \brief Get the grid pattern for the given parameters
+ *
+ *  \par Function Description
+ *  Returns the cached grid pattern if it was rendered with the
+ *  same parameters, otherwise renders it anew.  The pattern
+ *  repeats a tile containing a whole number of pattern periods,
+ *  which are \a key->multiplier grid steps long.
+ *
+ *  \param [in] key The grid parameters.
+ *  \returns The pattern owned by the cache, or NULL if the grid
+ *           spacing does not allow repeating a tile.
+ */
+static cairo_pattern_t*
+get_grid_pattern (const GridPatternKey *key)
+{
+  int columns, rows, width, height;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  if ((grid_pattern != NULL) &&
+      (memcmp (&grid_pattern_key, key, sizeof (GridPatternKey)) == 0)) {
+    return grid_pattern;
+  }
+
+  if (grid_pattern != NULL) {
+    cairo_pattern_destroy (grid_pattern);
+    grid_pattern = NULL;
+  }
+
+  if (!grid_tile_size (key->period_x * key->multiplier, &columns, &width) ||
+      !grid_tile_size (key->period_y * key->multiplier, &rows, &height)) {
+    return NULL;
+  }
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+
+  if (key->mode == GRID_MODE_DOTS) {
+    render_dots_tile (cr, key, columns, rows, width, height);
+  } else {
+    render_mesh_tile (cr, key, columns, rows, width, height);
+  }
+
+  cairo_destroy (cr);
+
+  grid_pattern = cairo_pattern_create_for_surface (surface);
+  cairo_pattern_set_extend (grid_pattern, CAIRO_EXTEND_REPEAT);
+  cairo_pattern_set_filter (grid_pattern, CAIRO_FILTER_NEAREST);
+  cairo_surface_destroy (surface);
+
+  memcpy (&grid_pattern_key, key, sizeof (GridPatternKey));
+
+  return grid_pattern;
+}
+
+
+/*! \brief Paint an area of the screen with the cached grid pattern
+ *
+ *  \par Function Description
+ *  Fills the given region of the screen with the grid pattern
+ *  rendered once for the current scale, grid spacing, and colors.
+ *  The pattern is aligned to the grid point nearest to the top
+ *  left corner of the region.  Nothing is drawn if the target is
+ *  not a raster surface, or if the view is rotated or skewed.
+ *
+ *  \param [in] cr      The cairo context.
+ *  \param [in] key     The grid parameters, the period fields are
+ *                      set by this function.
+ *  \param [in] incr    The grid spacing in world units.
+ *  \param [in] x       The left screen coordinate for the drawing.
+ *  \param [in] y       The top screen coordinate for the drawing.
+ *  \param [in] width   The width of the region to draw.
+ *  \param [in] height  The height of the region to draw.
+ *  \returns TRUE if the region has been painted.
+ */
+static gboolean
+paint_grid_pattern (cairo_t *cr,
+                    GridPatternKey *key,
+                    int incr,
+                    int x, int y, int width, int height)
+{
+  cairo_matrix_t user_to_device_matrix;
+  cairo_matrix_t pattern_matrix;
+  cairo_pattern_t *pattern;
+  double anchor_x = x;
+  double anchor_y = y;
+  int period = incr * key->multiplier;
+
+  switch (cairo_surface_get_type (cairo_get_target (cr))) {
+    case CAIRO_SURFACE_TYPE_IMAGE:
+    case CAIRO_SURFACE_TYPE_XLIB:
+    case CAIRO_SURFACE_TYPE_XCB:
+    case CAIRO_SURFACE_TYPE_QUARTZ:
+    case CAIRO_SURFACE_TYPE_WIN32:
+      break;
+    default:
+      return FALSE;
+  }
+
+  cairo_get_matrix (cr, &user_to_device_matrix);
+
+  if ((user_to_device_matrix.xy != 0) || (user_to_device_matrix.yx != 0)) {
+    return FALSE;
+  }
+
+  key->period_x = fabs (user_to_device_matrix.xx) * incr;
+  key->period_y = fabs (user_to_device_matrix.yy) * incr;
+
+  pattern = get_grid_pattern (key);
+
+  if (pattern == NULL) {
+    return FALSE;
+  }
+
+  /* Align the pattern to the grid point nearest to the region */
+  cairo_device_to_user (cr, &anchor_x, &anchor_y);
+  anchor_x = round (anchor_x / period) * period;
+  anchor_y = round (anchor_y / period) * period;
+  cairo_user_to_device (cr, &anchor_x, &anchor_y);
+
+  cairo_matrix_init_translate (&pattern_matrix,
+                               -round (anchor_x),
+                               -round (anchor_y));
+  cairo_pattern_set_matrix (pattern, &pattern_matrix);
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+  cairo_set_source (cr, pattern);
+  cairo_rectangle (cr, x, y, width, height);
+  cairo_fill (cr);
+  cairo_restore (cr);
+
+  return TRUE;
+}
+
 
 /*! \brief Query the spacing in world coordinates at which the dots grid is drawn.
  *
@@ -104,6 +408,18 @@ draw_dots_grid_region (GschemToplevel *w_current, cairo_t *cr, int x, int y, int
   int dot_size = MIN (w_current->dots_grid_dot_size, 5);
 
   LeptonColor *color = x_color_lookup (DOTS_GRID_COLOR);
+
+  GridPatternKey key;
+  memset (&key, 0, sizeof (key));
+  key.mode = GRID_MODE_DOTS;
+  key.multiplier = 1;
+  key.dot_size = dot_size;
+  grid_key_set_color (&key, 0, color);
+
+  if (paint_grid_pattern (cr, &key, incr, x, y, width, height)) {
+    return;
+  }
+
   cairo_set_source_rgba (cr,
                          lepton_color_get_red_double (color),
                          lepton_color_get_green_double (color),
@@ -299,6 +615,21 @@ draw_mesh_grid_region (GschemToplevel *w_current, cairo_t *cr, int x, int y, int
 
   cairo_device_to_user_distance (cr, &threshold, &dummy);
 
+  if (coarse_increment >= threshold) {
+    GridPatternKey key;
+
+    memset (&key, 0, sizeof (key));
+    key.mode = GRID_MODE_MESH;
+    key.multiplier = MESH_COARSE_GRID_MULTIPLIER;
+    key.fine = (snap_size >= threshold);
+    grid_key_set_color (&key, 0, x_color_lookup (MESH_GRID_MAJOR_COLOR));
+    grid_key_set_color (&key, 1, x_color_lookup (MESH_GRID_MINOR_COLOR));
+
+    if (paint_grid_pattern (cr, &key, snap_size, x, y, width, height)) {
+      return;
+    }
+  }
+
   if (coarse_increment >= threshold) {
     cairo_matrix_t user_to_device_matrix;
     double x_start = x - 1;
@@ -1199,7 +1199,7 @@ x_tabs_cancel_all (GschemToplevel* w_current)
   schematic_keys_reset (w_current);
 
   GschemPageView* pview = gschem_toplevel_get_current_page_view (w_current);
-  gschem_page_view_invalidate_all (pview);
+  gschem_page_view_invalidate_window (pview);
 
   i_action_stop (w_current);
 
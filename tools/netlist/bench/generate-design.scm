@@ -0,0 +1,212 @@
+;;; Lepton EDA netlister
+;;; Copyright (C) 2022 Lepton EDA Contributors
+;;;
+;;; This program is free software; you can redistribute it and/or modify
+;;; it under the terms of the GNU General Public License as published by
+;;; the Free Software Foundation; either version 2 of the License, or
+;;; (at your option) any later version.
+;;;
+;;; This program is distributed in the hope that it will be useful,
+;;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;;; GNU General Public License for more details.
+;;;
+;;; You should have received a copy of the GNU General Public License
+;;; along with this program; if not, write to the Free Software
+;;; Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+;;; Synthetic design generator for netlister benchmarks.
+;;;
+;;; Usage:
+;;;   guile generate-design.scm DIR SHEETS COMPONENTS [INSTANCES]
+;;;
+;;; Creates in DIR a design consisting of SHEETS toplevel pages
+;;; named "sheetN.sch", each containing COMPONENTS components
+;;; using stock symbols: chains of resistors and capacitors, slots
+;;; of 7400 gates, a bus with net rippers, and INSTANCES (4 by
+;;; default) instances of a hierarchical block "cell.sym" whose
+;;; schematic, "cell.sch", is referenced by the "source="
+;;; attribute.  Nets having the same names on different pages
+;;; connect the pages together.  The file "gafrc" in DIR adds DIR
+;;; to the symbol and source libraries.
+
+(use-modules (ice-9 format)
+             (ice-9 receive))
+
+;;; Component spacing.
+(define %dx 2000)
+(define %dy 1500)
+(define %columns 20)
+
+;;; Bus width.
+(define %bus-width 8)
+
+
+(define (attrib port x y name value)
+  (format port "T ~A ~A 5 10 1 1 0 0 1\n~A=~A\n" x y name value))
+
+(define* (component port x y symbol #:rest attribs)
+  (format port "C ~A ~A 1 0 0 ~A\n{\n" x y symbol)
+  (let loop ((attribs attribs) (dy 0))
+    (unless (null? attribs)
+      (attrib port x (+ y 600 dy) (car attribs) (cadr attribs))
+      (loop (cddr attribs) (+ dy 200))))
+  (display "}\n" port))
+
+(define* (net port x1 y1 x2 y2 #:optional netname)
+  (format port "N ~A ~A ~A ~A 4\n" x1 y1 x2 y2)
+  (when netname
+    (display "{\n" port)
+    (attrib port x1 (+ y1 100) "netname" netname)
+    (display "}\n" port)))
+
+(define (bus port x1 y1 x2 y2 netname)
+  (format port "U ~A ~A ~A ~A 10 0\n{\n" x1 y1 x2 y2)
+  (attrib port x1 (+ y1 100) "netname" netname)
+  (display "}\n" port))
+
+
+;;; Hierarchical block: a resistor between its ports A and B and a
+;;; capacitor from B to ground.
+(define (write-cell-symbol port)
+  (display "v 20031019 1
+B 300 0 800 800 3 0 0 0 -1 -1 0 -1 -1 -1 -1 -1
+P 0 400 300 400 1 0 0
+{
+T 100 500 5 10 1 1 0 0 1
+pinnumber=1
+T 100 500 5 10 0 0 0 0 1
+pinseq=1
+T 400 400 5 10 1 1 0 0 1
+pinlabel=A
+}
+P 1100 400 800 400 1 0 0
+{
+T 900 500 5 10 1 1 0 0 1
+pinnumber=2
+T 900 500 5 10 0 0 0 0 1
+pinseq=2
+T 600 400 5 10 1 1 0 0 1
+pinlabel=B
+}
+T 300 900 8 10 1 1 0 0 1
+refdes=X?
+T 300 1100 8 10 0 0 0 0 1
+device=cell
+" port))
+
+(define (write-cell-schematic port)
+  (display "v 20031019 1\n" port)
+  ;; Port A: pin end at (600, 100).
+  (component port 0 0 "in-1.sym" "refdes" "A")
+  ;; Resistor from (1000, 100) to (1900, 100).
+  (net port 600 100 1000 100)
+  (component port 1000 0 "resistor-1.sym" "refdes" "R1" "value" "10k")
+  ;; Port B: pin end at (2600, 100).
+  (net port 1900 100 2600 100)
+  (component port 2600 0 "out-1.sym" "refdes" "B")
+  ;; Capacitor from (1900, -1000) to (2800, -1000).
+  (net port 1900 100 1900 -1000)
+  (component port 1900 -1200 "capacitor-1.sym" "refdes" "C1" "value" "10n")
+  (net port 2800 -1000 3200 -1000 "GND"))
+
+
+(define (write-sheet port sheet components instances)
+  (define (position index)
+    (values (* %dx (modulo index %columns))
+            (* %dy (quotient index %columns))))
+
+  (define (node k) (format #f "S~A_N~A" sheet k))
+  (define (shared-node k) (format #f "SHARED~A" k))
+
+  (display "v 20031019 1\n" port)
+
+  ;; Components.  Every chain element connects node k to node
+  ;; k+1, so all the components of a page form one long chain.
+  ;; Every fifth node gets a name shared with other pages.
+  (do ((k 0 (1+ k))) ((= k components))
+    (receive (x y) (position k)
+      (let ((left (if (zero? (modulo k 5)) (shared-node (+ sheet k)) (node k)))
+            (right (node (1+ k))))
+        (case (modulo k 4)
+          ;; Resistor: pins at (0, 100) and (900, 100).
+          ((0 1)
+           (component port x y "resistor-1.sym"
+                      "refdes" (format #f "R~A_~A" sheet k)
+                      "value" "1k"
+                      "footprint" "0805")
+           (net port (- x 400) (+ y 100) x (+ y 100) left)
+           (net port (+ x 900) (+ y 100) (+ x 1300) (+ y 100) right))
+          ;; Capacitor: pins at (0, 200) and (900, 200).
+          ((2)
+           (component port x y "capacitor-1.sym"
+                      "refdes" (format #f "C~A_~A" sheet k)
+                      "value" "100n"
+                      "footprint" "0805")
+           (net port (- x 400) (+ y 200) x (+ y 200) left)
+           (net port (+ x 900) (+ y 200) (+ x 1300) (+ y 200) right))
+          ;; NAND gate slot: inputs at (0, 300) and (0, 700), output
+          ;; at (1300, 500).  Four consecutive gates share a package.
+          ((3)
+           (component port x y "7400-1.sym"
+                      "refdes" (format #f "U~A_~A" sheet (quotient k 16))
+                      "slot" (number->string (1+ (modulo (quotient k 4) 4)))
+                      "footprint" "DIP14")
+           (net port (- x 400) (+ y 300) x (+ y 300) left)
+           (net port (- x 400) (+ y 700) x (+ y 700) "GND")
+           (net port (+ x 1300) (+ y 500) (+ x 1700) (+ y 500) right))))))
+
+  ;; Bus with rippers connecting to the first nodes of the page.
+  (let ((y (- %dy)))
+    (bus port 0 y (* %dx %bus-width) y (format #f "D~A[0:~A]" sheet (1- %bus-width)))
+    (do ((k 0 (1+ k))) ((= k (min %bus-width components)))
+      (net port (+ (* %dx k) 100) y (+ (* %dx k) 100) (- y 500)
+           (node k))))
+
+  ;; Hierarchical instances connecting pairs of nodes.
+  (let ((y (* -3 %dy)))
+    (do ((i 0 (1+ i))) ((= i instances))
+      (let ((x (* %dx i)))
+        (component port x y "cell.sym"
+                   "refdes" (format #f "X~A_~A" sheet i)
+                   "source" "cell.sch")
+        (net port (- x 400) (+ y 400) x (+ y 400)
+             (node (modulo (* 2 i) (max components 1))))
+        (net port (+ x 1100) (+ y 400) (+ x 1500) (+ y 400)
+             (node (modulo (1+ (* 2 i)) (max components 1))))))))
+
+
+(define (write-file dir name proc)
+  (call-with-output-file (string-append dir "/" name) proc))
+
+
+(define (main args)
+  (define (usage)
+    (format (current-error-port)
+            "Usage: ~A DIR SHEETS COMPONENTS [INSTANCES]\n"
+            (car args))
+    (exit 1))
+
+  (unless (<= 4 (length args) 5) (usage))
+
+  (let ((dir-name (list-ref args 1))
+        (sheets (string->number (list-ref args 2)))
+        (components (string->number (list-ref args 3)))
+        (instances (if (= (length args) 5)
+                       (string->number (list-ref args 4))
+                       4)))
+    (unless (and sheets components instances) (usage))
+    (unless (file-exists? dir-name) (mkdir dir-name))
+    (let ((dir (canonicalize-path dir-name)))
+      (write-file dir "cell.sym" write-cell-symbol)
+      (write-file dir "cell.sch" write-cell-schematic)
+      (write-file dir "gafrc"
+                  (lambda (port)
+                    (format port "(component-library ~S)\n(source-library ~S)\n"
+                            dir dir)))
+      (do ((sheet 1 (1+ sheet))) ((> sheet sheets))
+        (write-file dir (format #f "sheet~A.sch" sheet)
+                    (lambda (port)
+                      (write-sheet port sheet components instances)))))))
+
+(main (command-line))
@@ -25,6 +25,7 @@
              (lepton toplevel)
              (lepton version)
              (netlist option)
+             (netlist server)
              (netlist))
 
 ;;; Initialize liblepton library.
@@ -51,6 +52,10 @@
     (backend-option (single-char #\O) (value #t))
     (list-backends (single-char #\b))
     (output (single-char #\o) (value #t))
+    (cache-dir (value #t))
+    (profile)
+    (profile-format (value #t))
+    (server (value #t))
     (pre-load (single-char #\l) (value #t))
     (post-load (single-char #\m) (value #t))
     (eval-code (single-char #\c) (value #t))
@@ -77,4 +82,7 @@
     ;; logging is enabled.
     (init-log "netlist")
     (display-lepton-version #:print-name #t #:log #t)
-    (main)))
+    (let ((socket-path (netlist-option-ref 'server)))
+      (if socket-path
+          (netlist-server socket-path %option-spec)
+          (main)))))
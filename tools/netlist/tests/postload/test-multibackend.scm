@@ -0,0 +1,12 @@
+;;; Loaded by -m along with each of several backends.  Every
+;;; backend is loaded into a fresh module, so the definition below
+;;; must not be seen when the next backend is loaded.
+(when (defined? 'multibackend-test-loaded)
+  (primitive-exit 101))
+(define multibackend-test-loaded #t)
+
+;;; Record each load to check that the file is loaded once per
+;;; backend.
+(let ((port (open-file "postload.log" "a")))
+  (display "loaded\n" port)
+  (close-port port))
@@ -234,10 +234,26 @@ build_and_run_command (const gchar *format, ...)
   return result;
 }
 
-/* Run gnetlist to generate a netlist and a PCB board file.  gnetlist
- * has exit status of 0 even if it's given an invalid arg, so do some
- * stat() hoops to decide if gnetlist successfully generated the PCB
- * board file (only gnetlist >= 20030901 recognizes -m).
+/* Append "-g BACKEND:FILE" arguments to ARGS.  The strings are
+ * stored in STRINGS to be freed by the caller.
+ */
+static GList *
+append_backend_args (GList *args, GList **strings,
+                     const gchar *backend, const gchar *file)
+{
+  gchar *arg = g_strconcat (backend, ":", file, NULL);
+
+  *strings = g_list_prepend (*strings, arg);
+  args = g_list_append (args, (gpointer) "-g");
+  return g_list_append (args, arg);
+}
+
+/* Run gnetlist to generate a netlist and a PCB board file.  All
+ * backends are run by one gnetlist process, so the schematics are
+ * loaded only once.  gnetlist has exit status of 0 even if it's
+ * given an invalid arg, so do some stat() hoops to decide if
+ * gnetlist successfully generated the PCB board file (only
+ * gnetlist >= 20030901 recognizes -m).
  */
 static gboolean
 run_gnetlist (gchar * pins_file, gchar * net_file, gchar * pcb_file,
@@ -249,6 +265,9 @@ run_gnetlist (gchar * pins_file, gchar * net_file, gchar * pcb_file,
   GList *list = NULL;
   GList *verboseList = NULL;
   GList *args1 = NULL;
+  GList *backend_args = NULL;
+  GList *strings = NULL;
+  gboolean result = TRUE;
 
   /* Allow the user to specify a full path or a different name for
    * the gnetlist command.  Especially useful if multiple copies
@@ -262,23 +281,40 @@ run_gnetlist (gchar * pins_file, gchar * net_file, gchar * pcb_file,
   if (!verbose)
     verboseList = g_list_append (verboseList, (gpointer) "-q");
 
-  if (!build_and_run_command ("%s %l -g %s -o %s %l %l",
-			      gnetlist,
-			      verboseList,
-			      backend_mkfile_cmd ? backend_mkfile_cmd : backend_mkfile_cmd_default,
-			      pins_file,
-			      extra_gnetlist_arg_list,
-			      largs))
-    return FALSE;
+  backend_args =
+    append_backend_args (backend_args, &strings,
+                         backend_mkfile_cmd ? backend_mkfile_cmd : backend_mkfile_cmd_default,
+                         pins_file);
+  backend_args =
+    append_backend_args (backend_args, &strings,
+                         backend_mkfile_net ? backend_mkfile_net : backend_mkfile_net_default,
+                         net_file);
+  backend_args =
+    append_backend_args (backend_args, &strings,
+                         backend_mkfile_pcb ? backend_mkfile_pcb : backend_mkfile_pcb_default,
+                         pcb_file);
 
-  if (!build_and_run_command ("%s %l -g %s -o %s %l %l",
-			      gnetlist,
-			      verboseList,
-			      backend_mkfile_net ? backend_mkfile_net : backend_mkfile_net_default,
-			      net_file,
-			      extra_gnetlist_arg_list,
-			      largs))
-    return FALSE;
+  for (list = extra_gnetlist_list; list; list = g_list_next (list)) {
+    const gchar *s = (gchar *) list->data;
+    const gchar *s2 = strstr (s, " -o ");
+    gchar *out_file;
+    gchar *backend;
+    if (!s2) {
+      out_file = g_strconcat (basename, ".", s, NULL);
+      backend = g_strdup (s);
+    } else {
+      out_file = g_strdup (s2 + 4);
+      backend = g_strndup (s, s2 - s);
+    }
+
+    backend_args = append_backend_args (backend_args, &strings,
+                                        backend, out_file);
+    g_free (out_file);
+    g_free (backend);
+  }
+
+  /* The override file only defines variables of the gsch2pcb
+   * backend, so it is harmless for the other backends. */
   create_m4_override_file ();
 
   if (m4_override_file) {
@@ -288,14 +324,13 @@ run_gnetlist (gchar * pins_file, gchar * net_file, gchar * pcb_file,
 
   mtime = (stat (pcb_file, &st) == 0) ? st.st_mtime : 0;
 
-  if (!build_and_run_command ("%s %l -g %s -o %s %l %l %l",
+  if (!build_and_run_command ("%s %l %l %l %l %l",
 			      gnetlist,
 			      verboseList,
-			      backend_mkfile_pcb ? backend_mkfile_pcb : backend_mkfile_pcb_default,
-			      pcb_file,
+			      backend_args,
 			      args1,
 			      extra_gnetlist_arg_list,
-                  largs)) {
+			      largs)) {
       if (stat (pcb_file, &st) != 0 || mtime == st.st_mtime) {
           fprintf (stderr,
                    "lepton-sch2pcb: netlister command failed, `%s' not updated\n",
@@ -304,43 +339,19 @@ run_gnetlist (gchar * pins_file, gchar * net_file, gchar * pcb_file,
           if (m4_override_file)
               fprintf (stderr,
                        "    At least gnetlist 20030901 is required for m4-xxx options.\n");
-          return FALSE;
       }
-      return FALSE;
+      result = FALSE;
   }
 
   if (m4_override_file)
     unlink (m4_override_file);
 
-  for (list = extra_gnetlist_list; list; list = g_list_next (list)) {
-    const gchar *s = (gchar *) list->data;
-    const gchar *s2 = strstr (s, " -o ");
-    gchar *out_file;
-    gchar *backend;
-    if (!s2) {
-      out_file = g_strconcat (basename, ".", s, NULL);
-      backend = g_strdup (s);
-    } else {
-      out_file = g_strdup (s2 + 4);
-      backend = g_strndup (s, s2 - s);
-    }
-
-    if (!build_and_run_command ("%s %l -g %s -o %s %l %l",
-				gnetlist,
-				verboseList,
-				backend,
-				out_file,
-				extra_gnetlist_arg_list,
-				largs))
-      return FALSE;
-    g_free (out_file);
-    g_free (backend);
-  }
-
+  g_list_free_full (strings, g_free);
+  g_list_free (backend_args);
   g_list_free (args1);
   g_list_free (verboseList);
 
-  return TRUE;
+  return result;
 }
 
 static gchar *